@@ -1,4 +1,4 @@
-QT       += core gui widgets serialport charts
+QT       += core gui widgets serialport charts concurrent
 
 CONFIG += c++17
 
@@ -8,16 +8,52 @@ CONFIG += c++17
 
 SOURCES += \
     datareceiver.cpp \
+    frameparser.cpp \
     main.cpp \
     mainwindow.cpp \
+    sensordata.cpp \
     datalogger.cpp \
+    logwriter.cpp \
+    csvlogwriter.cpp \
+    csvlogreader.cpp \
+    binarylogwriter.cpp \
+    binarylogreader.cpp \
+    gorillacodec.cpp \
+    logsession.cpp \
+    logindex.cpp \
+    logcache.cpp \
+    derivedexpression.cpp \
+    derivedchannelengine.cpp \
+    channeldata.cpp \
+    lodpyramid.cpp \
+    channelstatistics.cpp \
+    livechannelbuffer.cpp \
+    livechartwidget.cpp \
     interactivechartview.cpp
 
 HEADERS += \
     datareceiver.h \
+    frameparser.h \
     mainwindow.h \
     sensordata.h \
     datalogger.h \
+    logwriter.h \
+    csvlogwriter.h \
+    csvlogreader.h \
+    binarylogformat.h \
+    binarylogwriter.h \
+    binarylogreader.h \
+    gorillacodec.h \
+    logsession.h \
+    logindex.h \
+    logcache.h \
+    derivedexpression.h \
+    derivedchannelengine.h \
+    channeldata.h \
+    lodpyramid.h \
+    channelstatistics.h \
+    livechannelbuffer.h \
+    livechartwidget.h \
     interactivechartview.h
 
 FORMS += \
@@ -0,0 +1,99 @@
+#ifndef BINARYLOGFORMAT_H
+#define BINARYLOGFORMAT_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtEndian>
+
+/*
+ * Binäärilokin (.gmlog) rakenne. Kaikki luvut ovat little-endian.
+ *
+ * Tiedoston otsikko (16 tavua):
+ * - 4 tavua: "GMLB"
+ * - u16: formaatin versio
+ * - u16: varattu
+ * - i64: luontiaika millisekunteina epochista
+ *
+ * Sen jälkeen peräkkäisiä lohkoja. Jokainen lohko sisältää yhden kanavan
+ * (anturityypin) näytteitä:
+ * - u32: ChunkMagic
+ * - u8: anturityyppi
+ * - u8: koodaus (ChunkEncoding)
+ * - u16: varattu
+ * - u32: näytteiden määrä
+ * - u32: datan koko tavuina
+ * - data, Raw-koodauksella ensin kaikki aikaleimat (i64 ms) ja sitten arvot (f64),
+ *   Gorilla-koodauksella pakattuna (gorillacodec.h)
+ *
+ * Tiedoston lopussa on hakemisto, josta lukija löytää lohkot lukematta dataa:
+ * - u32: kanavien määrä; jokaiselle u8 tyyppi, u8 desimaalit,
+ *   u16 + UTF-8 nimi, u16 + UTF-8 yksikkö
+ * - u32: lohkojen määrä; jokaiselle ChunkIndexEntrySize tavua:
+ *   u8 tyyppi, u8 koodaus, u16 varattu, u32 näytteet, u64 lohkon sijainti,
+ *   u32 datan koko, i64 ensimmäinen ja i64 viimeinen aikaleima, f64 pienin ja f64 suurin arvo
+ * - u64: hakemiston sijainti
+ * - u32: FooterMagic
+ *
+ * Lokituksen aikana valmiiden lohkojen perässä voi olla häntä: samanlaisia
+ * lohkoja keskeneräisten lohkojen tallennetuista näytteistä. Häntää ei
+ * kirjata hakemistoon, ja close() poistaa sen ennen hakemistoa.
+ *
+ * Jos ohjelma kaatuu ennen hakemiston kirjoittamista, lukija rakentaa
+ * hakemiston käymällä lohkot läpi järjestyksessä.
+ */
+namespace BinaryLog {
+
+constexpr char FileMagic[4] = { 'G', 'M', 'L', 'B' };
+constexpr quint16 FormatVersion = 1;
+constexpr quint32 ChunkMagic = 0x4B4E4843;  // "CHNK"
+constexpr quint32 FooterMagic = 0x58444E49; // "INDX"
+
+constexpr int FileHeaderSize = 16;
+constexpr int ChunkHeaderSize = 16;
+constexpr int ChunkIndexEntrySize = 52;
+constexpr int TrailerSize = 12;
+
+constexpr int ChunkSamples = 4096; // Lohko kirjoitetaan viimeistään tämän kokoisena
+
+enum class ChunkEncoding : quint8 {
+    Raw = 0,    // Aikaleimat i64 ja arvot f64 sarakkeittain
+    Gorilla = 1 // Delta-of-delta-aikaleimat ja XOR-arvot
+};
+
+// Yhden lohkon tiedot hakemistossa
+struct ChunkInfo {
+    quint8 type;
+    ChunkEncoding encoding;
+    quint32 count;
+    qint64 offset;  // Lohkon otsikon sijainti tiedostossa
+    quint32 size;   // Datan koko ilman otsikkoa
+    qint64 firstMs;
+    qint64 lastMs;
+    double minValue;
+    double maxValue;
+};
+
+// Kanavan kuvaus ja lohkoista koottu yhteenveto
+struct ChannelInfo {
+    quint8 type;
+    QString name;
+    QString unit;
+    int decimals;
+    quint64 sampleCount;
+    qint64 firstMs;
+    qint64 lastMs;
+    double minValue;
+    double maxValue;
+};
+
+template <typename T>
+inline void appendValue(QByteArray &out, T value)
+{
+    char bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, sizeof(T));
+}
+
+} // namespace BinaryLog
+
+#endif // BINARYLOGFORMAT_H
@@ -0,0 +1,307 @@
+#include "binarylogreader.h"
+#include "gorillacodec.h"
+#include "sensordata.h"
+
+#include <QObject>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace BinaryLog;
+
+namespace {
+
+// Lukukursori tavutaulukkoon. Ylivuoto merkitään, ja sen jälkeen luetaan nollia.
+class Cursor
+{
+public:
+    Cursor(const char *data, qsizetype size) : m_data(data), m_size(size) {}
+
+    template <typename T>
+    T read()
+    {
+        if (m_pos + qsizetype(sizeof(T)) > m_size) {
+            m_ok = false;
+            m_pos = m_size;
+            return T();
+        }
+        const T value = qFromLittleEndian<T>(m_data + m_pos);
+        m_pos += sizeof(T);
+        return value;
+    }
+
+    QString readString()
+    {
+        const quint16 length = read<quint16>();
+        if (m_pos + length > m_size) {
+            m_ok = false;
+            m_pos = m_size;
+            return QString();
+        }
+        const QString text = QString::fromUtf8(m_data + m_pos, length);
+        m_pos += length;
+        return text;
+    }
+
+    bool ok() const { return m_ok; }
+
+private:
+    const char *m_data;
+    qsizetype m_size;
+    qsizetype m_pos = 0;
+    bool m_ok = true;
+};
+
+ChunkInfo parseChunkHeader(Cursor &in, qint64 offset, bool &valid)
+{
+    ChunkInfo chunk {};
+    valid = in.read<quint32>() == ChunkMagic;
+    chunk.type = in.read<quint8>();
+    chunk.encoding = static_cast<ChunkEncoding>(in.read<quint8>());
+    in.read<quint16>();
+    chunk.count = in.read<quint32>();
+    chunk.size = in.read<quint32>();
+    chunk.offset = offset;
+    valid = valid && in.ok();
+    return chunk;
+}
+
+} // namespace
+
+bool BinaryLogReader::fail(const QString &error)
+{
+    m_error = error;
+    m_file.close();
+    return false;
+}
+
+bool BinaryLogReader::open(const QString &filePath)
+{
+    close();
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return fail(m_file.errorString());
+    }
+    if (!readHeader()) {
+        return fail(QObject::tr("Tiedosto ei ole binääriloki."));
+    }
+
+    m_recovered = !readFooter();
+    if (m_recovered && !scanChunks()) {
+        return fail(QObject::tr("Binäärilokin lohkoja ei voitu lukea."));
+    }
+    return true;
+}
+
+void BinaryLogReader::close()
+{
+    m_file.close();
+    m_error.clear();
+    m_recovered = false;
+    m_channels.clear();
+    m_chunks.clear();
+}
+
+bool BinaryLogReader::readHeader()
+{
+    char header[FileHeaderSize];
+    if (m_file.read(header, FileHeaderSize) != FileHeaderSize) {
+        return false;
+    }
+    return std::memcmp(header, FileMagic, sizeof(FileMagic)) == 0
+        && qFromLittleEndian<quint16>(header + 4) <= FormatVersion;
+}
+
+bool BinaryLogReader::readFooter()
+{
+    const qint64 fileSize = m_file.size();
+    if (fileSize < FileHeaderSize + TrailerSize) {
+        return false;
+    }
+
+    char trailer[TrailerSize];
+    if (!m_file.seek(fileSize - TrailerSize) || m_file.read(trailer, TrailerSize) != TrailerSize) {
+        return false;
+    }
+    const qint64 footerOffset = qint64(qFromLittleEndian<quint64>(trailer));
+    if (qFromLittleEndian<quint32>(trailer + 8) != FooterMagic
+        || footerOffset < FileHeaderSize || footerOffset > fileSize - TrailerSize) {
+        return false;
+    }
+
+    if (!m_file.seek(footerOffset)) {
+        return false;
+    }
+    const QByteArray footer = m_file.read(fileSize - TrailerSize - footerOffset);
+    Cursor in(footer.constData(), footer.size());
+
+    QList<ChannelInfo> described;
+    const quint32 channelCount = in.read<quint32>();
+    for (quint32 i = 0; i < channelCount && in.ok(); ++i) {
+        ChannelInfo channel {};
+        channel.type = in.read<quint8>();
+        channel.decimals = in.read<quint8>();
+        channel.name = in.readString();
+        channel.unit = in.readString();
+        described.append(channel);
+    }
+
+    const quint32 chunkCount = in.read<quint32>();
+    QList<ChunkInfo> chunks;
+    chunks.reserve(qMin<quint32>(chunkCount, quint32(footer.size() / ChunkIndexEntrySize)));
+    for (quint32 i = 0; i < chunkCount && in.ok(); ++i) {
+        ChunkInfo chunk;
+        chunk.type = in.read<quint8>();
+        chunk.encoding = static_cast<ChunkEncoding>(in.read<quint8>());
+        in.read<quint16>();
+        chunk.count = in.read<quint32>();
+        chunk.offset = qint64(in.read<quint64>());
+        chunk.size = in.read<quint32>();
+        chunk.firstMs = in.read<qint64>();
+        chunk.lastMs = in.read<qint64>();
+        chunk.minValue = in.read<double>();
+        chunk.maxValue = in.read<double>();
+        chunks.append(chunk);
+    }
+    if (!in.ok()) {
+        return false;
+    }
+
+    m_chunks = chunks;
+    buildChannels(described);
+    return true;
+}
+
+bool BinaryLogReader::scanChunks()
+{
+    // Hakemisto puuttuu: luetaan lohkot järjestyksessä ensimmäiseen vialliseen asti
+    const qint64 fileSize = m_file.size();
+    qint64 offset = FileHeaderSize;
+    QVector<qint64> timestamps;
+    QVector<double> values;
+
+    while (offset + ChunkHeaderSize <= fileSize) {
+        if (!m_file.seek(offset)) {
+            break;
+        }
+        const QByteArray header = m_file.read(ChunkHeaderSize);
+        Cursor in(header.constData(), header.size());
+        bool valid = false;
+        ChunkInfo chunk = parseChunkHeader(in, offset, valid);
+        if (!valid || offset + ChunkHeaderSize + chunk.size > fileSize || chunk.count == 0) {
+            break;
+        }
+
+        timestamps.clear();
+        values.clear();
+        if (!readChunk(chunk, timestamps, values)) {
+            break;
+        }
+        chunk.firstMs = timestamps.first();
+        chunk.lastMs = timestamps.last();
+        const auto [minIt, maxIt] = std::minmax_element(values.cbegin(), values.cend());
+        chunk.minValue = *minIt;
+        chunk.maxValue = *maxIt;
+        m_chunks.append(chunk);
+
+        offset += ChunkHeaderSize + chunk.size;
+    }
+
+    buildChannels({});
+    return !m_chunks.isEmpty();
+}
+
+void BinaryLogReader::buildChannels(const QList<ChannelInfo> &described)
+{
+    // Hakemiston kuvaus ensisijaisesti, muuten nykyinen anturirekisteri
+    m_channels.clear();
+    for (const ChunkInfo &chunk : std::as_const(m_chunks)) {
+        auto it = std::find_if(m_channels.begin(), m_channels.end(),
+                               [&chunk](const ChannelInfo &c) { return c.type == chunk.type; });
+        if (it == m_channels.end()) {
+            ChannelInfo channel {};
+            auto desc = std::find_if(described.cbegin(), described.cend(),
+                                     [&chunk](const ChannelInfo &c) { return c.type == chunk.type; });
+            if (desc != described.cend()) {
+                channel = *desc;
+            } else {
+                const SensorInfo &info = sensorInfo(static_cast<SensorType>(chunk.type));
+                channel.type = chunk.type;
+                channel.name = info.name;
+                channel.unit = info.unit;
+                channel.decimals = info.decimals;
+            }
+            channel.sampleCount = 0;
+            channel.firstMs = std::numeric_limits<qint64>::max();
+            channel.lastMs = std::numeric_limits<qint64>::min();
+            channel.minValue = std::numeric_limits<double>::max();
+            channel.maxValue = std::numeric_limits<double>::lowest();
+            m_channels.append(channel);
+            it = m_channels.end() - 1;
+        }
+
+        it->sampleCount += chunk.count;
+        it->firstMs = qMin(it->firstMs, chunk.firstMs);
+        it->lastMs = qMax(it->lastMs, chunk.lastMs);
+        it->minValue = qMin(it->minValue, chunk.minValue);
+        it->maxValue = qMax(it->maxValue, chunk.maxValue);
+    }
+}
+
+bool BinaryLogReader::readChunk(const ChunkInfo &chunk, QVector<qint64> &timestamps, QVector<double> &values)
+{
+    const bool raw = chunk.encoding == ChunkEncoding::Raw;
+    if ((!raw && chunk.encoding != ChunkEncoding::Gorilla)
+        || (raw && quint64(chunk.size) != quint64(chunk.count) * (sizeof(qint64) + sizeof(double)))) {
+        m_error = QObject::tr("Tuntematon lohkon koodaus.");
+        return false;
+    }
+    // Gorilla käyttää jokaiseen ensimmäisen jälkeiseen näytteeseen vähintään
+    // kaksi bittiä, joten viallinen näytemäärä hylätään ennen varausta
+    if (!raw && quint64(chunk.count) > quint64(chunk.size) * 4 + 1) {
+        m_error = QObject::tr("Pakattu lohko on viallinen.");
+        return false;
+    }
+    if (!m_file.seek(chunk.offset + ChunkHeaderSize)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    const QByteArray data = m_file.read(chunk.size);
+    if (data.size() != qsizetype(chunk.size)) {
+        m_error = QObject::tr("Lohko on katkennut.");
+        return false;
+    }
+
+    const qsizetype base = timestamps.size();
+    timestamps.resize(base + chunk.count);
+    values.resize(base + chunk.count);
+
+    if (raw) {
+        qFromLittleEndian<qint64>(data.constData(), chunk.count, timestamps.data() + base);
+        qFromLittleEndian<double>(data.constData() + chunk.count * sizeof(qint64), chunk.count, values.data() + base);
+        return true;
+    }
+
+    GorillaDecoder decoder(data.constData(), data.size(), chunk.count);
+    qint64 *t = timestamps.data() + base;
+    double *v = values.data() + base;
+    for (quint32 i = 0; i < chunk.count; ++i) {
+        if (!decoder.next(t[i], v[i])) {
+            timestamps.resize(base);
+            values.resize(base);
+            m_error = QObject::tr("Pakattu lohko on viallinen.");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BinaryLogReader::readChannel(quint8 type, QVector<qint64> &timestamps, QVector<double> &values)
+{
+    for (const ChunkInfo &chunk : std::as_const(m_chunks)) {
+        if (chunk.type == type && !readChunk(chunk, timestamps, values)) {
+            return false;
+        }
+    }
+    return true;
+}
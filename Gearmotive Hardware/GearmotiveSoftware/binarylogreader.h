@@ -0,0 +1,57 @@
+#ifndef BINARYLOGREADER_H
+#define BINARYLOGREADER_H
+
+#include <QFile>
+#include <QList>
+#include <QVector>
+#include "binarylogformat.h"
+
+/**
+ * @class BinaryLogReader
+ * @brief Lukee binäärilokin hakemiston ja kanavien dataa.
+ *
+ * open() lukee vain tiedoston lopun hakemiston, joten kanavien tiedot,
+ * aikavälit ja min/max-arvot ovat käytettävissä lukematta itse dataa.
+ * Jos hakemisto puuttuu (ohjelma kaatui lokituksen aikana), lohkot käydään
+ * läpi alusta ja ehjät lohkot otetaan käyttöön.
+ */
+class BinaryLogReader
+{
+public:
+    bool open(const QString &filePath);
+    void close();
+    QString errorString() const { return m_error; }
+
+    /**
+     * @brief true, jos hakemisto rakennettiin uudelleen lohkoista.
+     */
+    bool isRecovered() const { return m_recovered; }
+
+    const QList<BinaryLog::ChannelInfo> &channels() const { return m_channels; }
+    const QList<BinaryLog::ChunkInfo> &chunks() const { return m_chunks; }
+
+    /**
+     * @brief Lukee yhden lohkon näytteet ja lisää ne vektorien loppuun.
+     */
+    bool readChunk(const BinaryLog::ChunkInfo &chunk, QVector<qint64> &timestamps, QVector<double> &values);
+
+    /**
+     * @brief Lukee kanavan kaikki näytteet aikajärjestyksessä.
+     */
+    bool readChannel(quint8 type, QVector<qint64> &timestamps, QVector<double> &values);
+
+private:
+    bool readHeader();
+    bool readFooter();
+    bool scanChunks();
+    void buildChannels(const QList<BinaryLog::ChannelInfo> &described);
+    bool fail(const QString &error);
+
+    QFile m_file;
+    QString m_error;
+    bool m_recovered = false;
+    QList<BinaryLog::ChannelInfo> m_channels;
+    QList<BinaryLog::ChunkInfo> m_chunks;
+};
+
+#endif // BINARYLOGREADER_H
@@ -0,0 +1,274 @@
+#include "binarylogwriter.h"
+#include "gorillacodec.h"
+
+#include <QDateTime>
+#include <algorithm>
+
+using namespace BinaryLog;
+
+BinaryLogWriter::BinaryLogWriter(ChunkEncoding encoding)
+    : m_encoding(encoding)
+{
+}
+
+bool BinaryLogWriter::open(const QString &filePath)
+{
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    m_buffer.clear();
+    m_fileSize = 0;
+    m_tailEnd = 0;
+    m_channelOrder.clear();
+    m_chunks.clear();
+    for (auto &channel : m_channels) {
+        channel.reset();
+    }
+
+    m_buffer.append(FileMagic, sizeof(FileMagic));
+    appendValue<quint16>(m_buffer, FormatVersion);
+    appendValue<quint16>(m_buffer, 0);
+    appendValue<qint64>(m_buffer, QDateTime::currentMSecsSinceEpoch());
+    return true;
+}
+
+BinaryLogWriter::Channel &BinaryLogWriter::channel(SensorType type)
+{
+    std::unique_ptr<Channel> &slot = m_channels[quint8(type)];
+    if (!slot) {
+        slot = std::make_unique<Channel>();
+        slot->type = quint8(type);
+        slot->timestamps.reserve(ChunkSamples);
+        slot->values.reserve(ChunkSamples);
+        m_channelOrder.append(quint8(type));
+    }
+    return *slot;
+}
+
+bool BinaryLogWriter::write(const SensorSample *samples, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        Channel &c = channel(samples[i].type);
+        c.timestamps.append(samples[i].timestampMs);
+        c.values.append(samples[i].value);
+        if (c.timestamps.size() >= ChunkSamples) {
+            appendChunk(c);
+        }
+    }
+
+    if (m_buffer.size() >= 256 * 1024) {
+        return writeBuffer();
+    }
+    return true;
+}
+
+ChunkInfo BinaryLogWriter::encodeChunk(const Channel &channel, qsizetype begin, qint64 offset, QByteArray &out) const
+{
+    const int count = int(channel.timestamps.size() - begin);
+    const qint64 *timestamps = channel.timestamps.constData() + begin;
+    const double *values = channel.values.constData() + begin;
+
+    QByteArray encoded;
+    if (m_encoding == ChunkEncoding::Gorilla) {
+        GorillaEncoder encoder;
+        for (int i = 0; i < count; ++i) {
+            encoder.append(timestamps[i], values[i]);
+        }
+        encoded = encoder.finish();
+    }
+
+    ChunkInfo info;
+    info.type = channel.type;
+    info.encoding = m_encoding;
+    info.count = quint32(count);
+    info.offset = offset;
+    info.size = m_encoding == ChunkEncoding::Gorilla
+        ? quint32(encoded.size())
+        : quint32(count) * (sizeof(qint64) + sizeof(double));
+    info.firstMs = timestamps[0];
+    info.lastMs = timestamps[count - 1];
+    const auto [minIt, maxIt] = std::minmax_element(values, values + count);
+    info.minValue = *minIt;
+    info.maxValue = *maxIt;
+
+    appendValue<quint32>(out, ChunkMagic);
+    appendValue<quint8>(out, info.type);
+    appendValue<quint8>(out, quint8(info.encoding));
+    appendValue<quint16>(out, 0);
+    appendValue<quint32>(out, info.count);
+    appendValue<quint32>(out, info.size);
+
+    if (m_encoding == ChunkEncoding::Gorilla) {
+        out.append(encoded);
+    } else {
+        // Sarakkeet kopioidaan kerralla
+        const qsizetype pos = out.size();
+        out.resize(pos + qsizetype(info.size));
+        char *data = out.data() + pos;
+        qToLittleEndian<qint64>(timestamps, count, data);
+        qToLittleEndian<double>(values, count, data + count * sizeof(qint64));
+    }
+    return info;
+}
+
+void BinaryLogWriter::appendChunk(Channel &channel)
+{
+    if (channel.timestamps.isEmpty()) {
+        return;
+    }
+    m_chunks.append(encodeChunk(channel, 0, m_fileSize + m_buffer.size(), m_buffer));
+    channel.timestamps.clear();
+    channel.values.clear();
+    channel.stored = 0;
+}
+
+bool BinaryLogWriter::writeData()
+{
+    if (m_buffer.isEmpty()) {
+        return true;
+    }
+    if (!m_file.seek(m_fileSize)) {
+        return false;
+    }
+    const qint64 written = m_file.write(m_buffer);
+    if (written != m_buffer.size()) {
+        return false;
+    }
+    m_fileSize += written;
+    m_buffer.clear();
+    return true;
+}
+
+bool BinaryLogWriter::writeBuffer()
+{
+    const bool overwritesTail = !m_buffer.isEmpty() && m_tailEnd > m_fileSize;
+    if (!writeData()) {
+        return false;
+    }
+    // Valmiit lohkot kirjoitettiin hännän päälle; häntä kootaan uudelleen
+    // niiden perään, jotta jo tallennetut näytteet eivät katoa kaatumisessa
+    return !overwritesTail || rewriteTail();
+}
+
+bool BinaryLogWriter::rewriteTail()
+{
+    QByteArray tail;
+    for (quint8 type : m_channelOrder) {
+        Channel &channel = *m_channels[type];
+        if (!channel.timestamps.isEmpty()) {
+            encodeChunk(channel, 0, m_fileSize + tail.size(), tail);
+        }
+        channel.stored = channel.timestamps.size();
+    }
+    if (!tail.isEmpty() && (!m_file.seek(m_fileSize) || m_file.write(tail) != tail.size())) {
+        return false;
+    }
+
+    // Edellisen, pidemmän hännän loppu ei saa jäädä lohkoiksi tulkittavaksi
+    const qint64 end = m_fileSize + tail.size();
+    if (end < m_tailEnd && !m_file.resize(end)) {
+        return false;
+    }
+    m_tailEnd = end;
+    return true;
+}
+
+bool BinaryLogWriter::appendTail()
+{
+    // Hännän perään vain edellisen flushin jälkeen tulleet näytteet
+    const qint64 start = qMax(m_tailEnd, m_fileSize);
+    QByteArray delta;
+    for (quint8 type : m_channelOrder) {
+        Channel &channel = *m_channels[type];
+        if (channel.stored < channel.timestamps.size()) {
+            encodeChunk(channel, channel.stored, start + delta.size(), delta);
+            channel.stored = channel.timestamps.size();
+        }
+    }
+    if (delta.isEmpty()) {
+        return true;
+    }
+    if (!m_file.seek(start) || m_file.write(delta) != delta.size()) {
+        return false;
+    }
+    m_tailEnd = start + delta.size();
+    return true;
+}
+
+bool BinaryLogWriter::flush()
+{
+    // Keskeneräisiä lohkoja ei katkaista, vaan niiden uudet näytteet
+    // tallennetaan häntään, jotta kaatuminen ei vie niitä
+    return writeBuffer() && appendTail() && m_file.flush();
+}
+
+bool BinaryLogWriter::sync()
+{
+    return flush() && syncFile(m_file);
+}
+
+QByteArray BinaryLogWriter::footer() const
+{
+    QByteArray out;
+    appendValue<quint32>(out, quint32(m_channelOrder.size()));
+    for (quint8 type : m_channelOrder) {
+        const SensorInfo &info = sensorInfo(static_cast<SensorType>(type));
+        const QByteArray name = info.name.toUtf8();
+        const QByteArray unit = info.unit.toUtf8();
+        appendValue<quint8>(out, type);
+        appendValue<quint8>(out, quint8(info.decimals));
+        appendValue<quint16>(out, quint16(name.size()));
+        out.append(name);
+        appendValue<quint16>(out, quint16(unit.size()));
+        out.append(unit);
+    }
+
+    appendValue<quint32>(out, quint32(m_chunks.size()));
+    for (const ChunkInfo &chunk : m_chunks) {
+        appendValue<quint8>(out, chunk.type);
+        appendValue<quint8>(out, quint8(chunk.encoding));
+        appendValue<quint16>(out, 0);
+        appendValue<quint32>(out, chunk.count);
+        appendValue<quint64>(out, quint64(chunk.offset));
+        appendValue<quint32>(out, chunk.size);
+        appendValue<qint64>(out, chunk.firstMs);
+        appendValue<qint64>(out, chunk.lastMs);
+        appendValue<double>(out, chunk.minValue);
+        appendValue<double>(out, chunk.maxValue);
+    }
+    return out;
+}
+
+bool BinaryLogWriter::close()
+{
+    if (!m_file.isOpen()) {
+        return true;
+    }
+    // Keskeneräiset lohkot kirjataan nyt hakemistoon, ja niiden päälle
+    // jäävä hännän loppu poistetaan ennen hakemistoa
+    for (quint8 type : m_channelOrder) {
+        appendChunk(*m_channels[type]);
+    }
+    bool ok = writeData() && (m_tailEnd <= m_fileSize || m_file.resize(m_fileSize));
+    if (ok) {
+        const qint64 footerOffset = m_fileSize;
+        m_buffer = footer();
+        appendValue<quint64>(m_buffer, quint64(footerOffset));
+        appendValue<quint32>(m_buffer, FooterMagic);
+        ok = writeData() && m_file.flush();
+    }
+    m_file.close();
+    return ok;
+}
+
+QString BinaryLogWriter::errorString() const
+{
+    return m_file.errorString();
+}
+
+qint64 BinaryLogWriter::bytesWritten() const
+{
+    return m_fileSize + m_buffer.size();
+}
@@ -0,0 +1,68 @@
+#ifndef BINARYLOGWRITER_H
+#define BINARYLOGWRITER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QVector>
+#include <array>
+#include <memory>
+#include "binarylogformat.h"
+#include "logwriter.h"
+
+/**
+ * @class BinaryLogWriter
+ * @brief Kirjoittaa näytteet binäärilokiin kanavakohtaisina lohkoina.
+ *
+ * Näytteet kerätään kanavittain, ja lohko kirjoitetaan, kun siinä on
+ * BinaryLog::ChunkSamples näytettä tai kun loki suljetaan. Hakemisto
+ * kirjoitetaan close()-kutsussa. Rakenne on kuvattu binarylogformat.h:ssa.
+ *
+ * flush() ei katkaise keskeneräisiä lohkoja. Niiden edellisen flushin
+ * jälkeen tulleet näytteet lisätään valmiiden lohkojen perään häntään, joka
+ * koostuu tavallisista lohkoista mutta jota ei kirjata hakemistoon. Kaatumisen
+ * jälkeen lukija löytää hännän lohkoja läpikäydessään. Kun valmis lohko
+ * kirjoitetaan hännän päälle, häntä kootaan uudelleen sen perään yhdeksi
+ * lohkoksi kanavaa kohden.
+ */
+class BinaryLogWriter : public LogWriter
+{
+public:
+    explicit BinaryLogWriter(BinaryLog::ChunkEncoding encoding = BinaryLog::ChunkEncoding::Gorilla);
+
+    bool open(const QString &filePath) override;
+    bool write(const SensorSample *samples, int count) override;
+    bool flush() override;
+    bool sync() override;
+    bool close() override;
+    QString errorString() const override;
+    qint64 bytesWritten() const override;
+
+private:
+    struct Channel {
+        quint8 type;
+        QVector<qint64> timestamps;
+        QVector<double> values;
+        qsizetype stored = 0; // Näytteet, jotka ovat jo hännässä
+    };
+
+    Channel &channel(SensorType type);
+    BinaryLog::ChunkInfo encodeChunk(const Channel &channel, qsizetype begin, qint64 offset, QByteArray &out) const;
+    void appendChunk(Channel &channel);
+    bool writeData();
+    bool writeBuffer();
+    bool rewriteTail();
+    bool appendTail();
+    QByteArray footer() const;
+
+    BinaryLog::ChunkEncoding m_encoding;
+    QFile m_file;
+    QByteArray m_buffer;
+    qint64 m_fileSize = 0; // Valmiiden lohkojen loppu; häntä alkaa tästä
+    qint64 m_tailEnd = 0;
+    std::array<std::unique_ptr<Channel>, 256> m_channels;
+    QList<quint8> m_channelOrder; // Kanavat ensimmäisen näytteen mukaisessa järjestyksessä
+    QList<BinaryLog::ChunkInfo> m_chunks;
+};
+
+#endif // BINARYLOGWRITER_H
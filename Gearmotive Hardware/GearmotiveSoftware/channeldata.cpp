@@ -0,0 +1,74 @@
+#include "channeldata.h"
+
+#include <algorithm>
+#include <numeric>
+
+bool ChannelData::append(const QVector<qint64> &timestamps, const QVector<double> &values)
+{
+    if (timestamps.isEmpty()) {
+        return true;
+    }
+
+    const bool inOrder = (m_timestamps.isEmpty() || m_timestamps.last() <= timestamps.first())
+        && std::is_sorted(timestamps.cbegin(), timestamps.cend());
+    m_timestamps.append(timestamps);
+    m_values.append(values);
+    if (!inOrder) {
+        sortByTime();
+    }
+    return inOrder;
+}
+
+void ChannelData::assign(QVector<qint64> timestamps, QVector<double> values)
+{
+    m_timestamps = std::move(timestamps);
+    m_values = std::move(values);
+    if (!std::is_sorted(m_timestamps.cbegin(), m_timestamps.cend())) {
+        sortByTime();
+    }
+}
+
+void ChannelData::clear()
+{
+    m_timestamps.clear();
+    m_values.clear();
+}
+
+qsizetype ChannelData::nearestIndex(qint64 timestampMs) const
+{
+    if (m_timestamps.isEmpty()) {
+        return -1;
+    }
+
+    // Ensimmäinen näyte, joka ei ole ennen haettua hetkeä, tai sitä edeltävä
+    const auto it = std::lower_bound(m_timestamps.cbegin(), m_timestamps.cend(), timestampMs);
+    if (it == m_timestamps.cend()) {
+        return m_timestamps.size() - 1;
+    }
+    const qsizetype index = it - m_timestamps.cbegin();
+    if (index > 0 && timestampMs - m_timestamps[index - 1] <= *it - timestampMs) {
+        return index - 1;
+    }
+    return index;
+}
+
+void ChannelData::sortByTime()
+{
+    // Vakaa järjestys säilyttää saman aikaleiman näytteiden keskinäisen järjestyksen
+    QVector<qsizetype> order(m_timestamps.size());
+    std::iota(order.begin(), order.end(), qsizetype(0));
+    std::stable_sort(order.begin(), order.end(), [this](qsizetype a, qsizetype b) {
+        return m_timestamps[a] < m_timestamps[b];
+    });
+
+    QVector<qint64> timestamps;
+    QVector<double> values;
+    timestamps.reserve(order.size());
+    values.reserve(order.size());
+    for (qsizetype i : std::as_const(order)) {
+        timestamps.append(m_timestamps[i]);
+        values.append(m_values[i]);
+    }
+    m_timestamps = std::move(timestamps);
+    m_values = std::move(values);
+}
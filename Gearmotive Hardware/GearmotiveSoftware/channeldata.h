@@ -0,0 +1,47 @@
+#ifndef CHANNELDATA_H
+#define CHANNELDATA_H
+
+#include <QVector>
+
+/**
+ * @class ChannelData
+ * @brief Yhden kanavan näytteet aikajärjestyksessä.
+ *
+ * Aikaleimat ja arvot ovat erillisissä taulukoissa, jotta haku kohdistimen
+ * kohdalla on binäärihaku pelkästä aikaleimataulukosta.
+ */
+class ChannelData
+{
+public:
+    /**
+     * @brief Lisää näytteet. Jos ne eivät jatka aikajärjestystä, kaikki näytteet järjestetään uudelleen.
+     * @return true, jos näytteet lisättiin loppuun; false, jos järjestys muuttui.
+     */
+    bool append(const QVector<qint64> &timestamps, const QVector<double> &values);
+
+    /**
+     * @brief Korvaa näytteet kopioimatta. Vektorit voivat viitata valmiiseen muistiin (fromRawData).
+     */
+    void assign(QVector<qint64> timestamps, QVector<double> values);
+    void clear();
+
+    qsizetype size() const { return m_timestamps.size(); }
+    bool isEmpty() const { return m_timestamps.isEmpty(); }
+    const QVector<qint64> &timestamps() const { return m_timestamps; }
+    const QVector<double> &values() const { return m_values; }
+    qint64 firstMs() const { return m_timestamps.first(); }
+    qint64 lastMs() const { return m_timestamps.last(); }
+
+    /**
+     * @brief Lähimmän näytteen indeksi (O(log n)), -1 jos kanava on tyhjä.
+     */
+    qsizetype nearestIndex(qint64 timestampMs) const;
+
+private:
+    void sortByTime();
+
+    QVector<qint64> m_timestamps;
+    QVector<double> m_values;
+};
+
+#endif // CHANNELDATA_H
@@ -0,0 +1,220 @@
+#include "channelstatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+void StatisticsSummary::add(double value)
+{
+    if (count == 0) {
+        min = value;
+        max = value;
+    } else {
+        min = qMin(min, value);
+        max = qMax(max, value);
+    }
+    ++count;
+    const double delta = value - mean;
+    mean += delta / double(count);
+    m2 += delta * (value - mean);
+}
+
+void StatisticsSummary::merge(const StatisticsSummary &other)
+{
+    if (other.count == 0) {
+        return;
+    }
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+
+    // Chanin kaava kahden osajoukon yhdistämiseen
+    const double total = double(count + other.count);
+    const double delta = other.mean - mean;
+    mean += delta * double(other.count) / total;
+    m2 += other.m2 + delta * delta * double(count) * double(other.count) / total;
+    count += other.count;
+    min = qMin(min, other.min);
+    max = qMax(max, other.max);
+}
+
+double StatisticsSummary::standardDeviation() const
+{
+    return std::sqrt(variance());
+}
+
+double StatisticsSummary::rms() const
+{
+    return std::sqrt(variance() + mean * mean);
+}
+
+void RollingStatistics::setWindow(qint64 windowMs)
+{
+    m_windowMs = qMax<qint64>(windowMs, 0);
+    clear();
+}
+
+void RollingStatistics::clear()
+{
+    m_summary = StatisticsSummary();
+    m_samples.clear();
+    m_minimums.clear();
+    m_maximums.clear();
+    m_nextSequence = 0;
+    m_removals = 0;
+}
+
+void RollingStatistics::add(qint64 timestampMs, double value)
+{
+    m_summary.add(value);
+    if (m_windowMs == 0) {
+        return;
+    }
+
+    // Jonoista poistetaan lopusta arvot, jotka eivät voi enää olla ikkunan
+    // minimi tai maksimi, koska uudempi näyte on yhtä pieni tai suuri
+    const Sample sample { timestampMs, value, m_nextSequence++ };
+    m_samples.push_back(sample);
+    while (!m_minimums.empty() && m_minimums.back().value >= value) {
+        m_minimums.pop_back();
+    }
+    m_minimums.push_back(sample);
+    while (!m_maximums.empty() && m_maximums.back().value <= value) {
+        m_maximums.pop_back();
+    }
+    m_maximums.push_back(sample);
+
+    // Ikkunaan kuuluvat näytteet välillä (timestampMs - windowMs, timestampMs]
+    while (m_samples.front().timestampMs <= timestampMs - m_windowMs) {
+        const Sample &expired = m_samples.front();
+        if (m_summary.count <= 1) {
+            m_summary = StatisticsSummary();
+        } else {
+            // Welfordin päivitys käänteisesti
+            const double delta = expired.value - m_summary.mean;
+            --m_summary.count;
+            m_summary.mean -= delta / double(m_summary.count);
+            m_summary.m2 = qMax(0.0, m_summary.m2 - delta * (expired.value - m_summary.mean));
+        }
+        if (m_minimums.front().sequence == expired.sequence) {
+            m_minimums.pop_front();
+        }
+        if (m_maximums.front().sequence == expired.sequence) {
+            m_maximums.pop_front();
+        }
+        m_samples.pop_front();
+        ++m_removals;
+    }
+
+    if (m_removals >= RecomputeInterval) {
+        recompute();
+    }
+}
+
+void RollingStatistics::recompute()
+{
+    m_summary = StatisticsSummary();
+    for (const Sample &sample : m_samples) {
+        m_summary.add(sample.value);
+    }
+    m_removals = 0;
+}
+
+StatisticsSummary RollingStatistics::summary() const
+{
+    StatisticsSummary summary = m_summary;
+    if (m_windowMs > 0 && !m_samples.empty()) {
+        summary.min = m_minimums.front().value;
+        summary.max = m_maximums.front().value;
+    }
+    return summary;
+}
+
+void StatisticsTree::build(const ChannelData &data)
+{
+    clear();
+    const qsizetype count = data.size();
+
+    // Taso 0 lasketaan suoraan näytteistä
+    QVector<StatisticsSummary> level;
+    level.reserve((count + LeafSize - 1) / LeafSize);
+    for (qsizetype begin = 0; begin < count; begin += LeafSize) {
+        StatisticsSummary leaf;
+        scan(data, begin, qMin(begin + LeafSize, count), leaf);
+        level.append(leaf);
+    }
+
+    // Ylemmät tasot yhdistävät solmuparit, kunnes jäljellä on yksi solmu
+    while (level.size() > 1) {
+        QVector<StatisticsSummary> next;
+        next.reserve((level.size() + 1) / 2);
+        for (qsizetype i = 0; i < level.size(); i += 2) {
+            StatisticsSummary node = level[i];
+            if (i + 1 < level.size()) {
+                node.merge(level[i + 1]);
+            }
+            next.append(node);
+        }
+        m_levels.append(std::move(level));
+        level = std::move(next);
+    }
+    m_levels.append(std::move(level));
+
+    m_sampleCount = count;
+    m_built = true;
+}
+
+void StatisticsTree::clear()
+{
+    m_built = false;
+    m_sampleCount = 0;
+    m_levels.clear();
+}
+
+void StatisticsTree::scan(const ChannelData &data, qsizetype begin, qsizetype end, StatisticsSummary &summary)
+{
+    const double *values = data.values().constData();
+    for (qsizetype i = begin; i < end; ++i) {
+        summary.add(values[i]);
+    }
+}
+
+StatisticsSummary StatisticsTree::range(const ChannelData &data, qint64 fromMs, qint64 toMs) const
+{
+    const QVector<qint64> &timestamps = data.timestamps();
+    const qsizetype begin = std::lower_bound(timestamps.cbegin(), timestamps.cend(), fromMs) - timestamps.cbegin();
+    const qsizetype end = std::upper_bound(timestamps.cbegin() + begin, timestamps.cend(), toMs) - timestamps.cbegin();
+    return rangeByIndex(data, begin, end);
+}
+
+StatisticsSummary StatisticsTree::rangeByIndex(const ChannelData &data, qsizetype begin, qsizetype end) const
+{
+    StatisticsSummary summary;
+    if (begin >= end) {
+        return summary;
+    }
+
+    // Osittaiset lohkot reunoilla käydään läpi suoraan
+    qsizetype firstLeaf = (begin + LeafSize - 1) / LeafSize;
+    qsizetype lastLeaf = end / LeafSize;
+    if (firstLeaf >= lastLeaf) {
+        scan(data, begin, end, summary);
+        return summary;
+    }
+    scan(data, begin, firstLeaf * LeafSize, summary);
+    scan(data, lastLeaf * LeafSize, end, summary);
+
+    // Kokonaiset lohkot [firstLeaf, lastLeaf) puretaan puun solmuiksi
+    for (int level = 0; firstLeaf < lastLeaf; ++level) {
+        const QVector<StatisticsSummary> &nodes = m_levels[level];
+        if (firstLeaf & 1) {
+            summary.merge(nodes[firstLeaf++]);
+        }
+        if (lastLeaf & 1) {
+            summary.merge(nodes[--lastLeaf]);
+        }
+        firstLeaf >>= 1;
+        lastLeaf >>= 1;
+    }
+    return summary;
+}
@@ -0,0 +1,117 @@
+#ifndef CHANNELSTATISTICS_H
+#define CHANNELSTATISTICS_H
+
+#include <QList>
+#include <QVector>
+#include <deque>
+#include "channeldata.h"
+
+/**
+ * @brief Näytejoukon tunnusluvut: määrä, keskiarvo, hajonnan neliösumma, minimi ja maksimi.
+ *
+ * Keskiarvo ja neliösumma päivitetään Welfordin menetelmällä, joten kaksi
+ * yhteenvetoa voi yhdistää ja yksittäisen näytteen poistaa ilman, että
+ * suurten arvojen neliösummat kumoavat toisensa.
+ */
+struct StatisticsSummary {
+    quint64 count = 0;
+    double mean = 0.0;
+    double m2 = 0.0; // Poikkeamien neliösumma keskiarvosta
+    double min = 0.0;
+    double max = 0.0;
+
+    void add(double value);
+    void merge(const StatisticsSummary &other);
+
+    bool isEmpty() const { return count == 0; }
+    double variance() const { return count > 0 ? m2 / double(count) : 0.0; }
+    double standardDeviation() const;
+    double rms() const;
+};
+
+/**
+ * @class RollingStatistics
+ * @brief Liukuvat tunnusluvut viimeisten windowMs millisekunnin näytteistä.
+ *
+ * Jokainen add() on tasoitetusti O(1): keskiarvo ja neliösumma päivitetään
+ * lisättävällä ja ikkunasta poistuvilla näytteillä, ja minimi ja maksimi
+ * saadaan monotonisten jonojen ensimmäisistä alkioista. Ikkuna 0 kattaa
+ * kaikki näytteet, jolloin näytteitä ei tarvitse säilyttää.
+ */
+class RollingStatistics
+{
+public:
+    /**
+     * @brief Asettaa ikkunan pituuden ja tyhjentää tilastot.
+     */
+    void setWindow(qint64 windowMs);
+    qint64 window() const { return m_windowMs; }
+
+    void add(qint64 timestampMs, double value);
+    void clear();
+
+    StatisticsSummary summary() const;
+
+private:
+    struct Sample {
+        qint64 timestampMs;
+        double value;
+        quint64 sequence;
+    };
+
+    // Liukuva päivitys kerää pyöristysvirhettä; ikkuna lasketaan uudelleen
+    // näin monen poiston välein
+    static constexpr quint64 RecomputeInterval = 1 << 16;
+
+    void recompute();
+
+    qint64 m_windowMs = 0;
+    StatisticsSummary m_summary;
+    std::deque<Sample> m_samples;   // Ikkunan näytteet saapumisjärjestyksessä
+    std::deque<Sample> m_minimums;  // Kasvavat arvot; ensimmäinen on ikkunan minimi
+    std::deque<Sample> m_maximums;  // Laskevat arvot; ensimmäinen on ikkunan maksimi
+    quint64 m_nextSequence = 0;
+    quint64 m_removals = 0;
+};
+
+/**
+ * @class StatisticsTree
+ * @brief Kanavan lohkoyhteenvetojen puu aikavälin tunnuslukujen hakuun.
+ *
+ * Taso 0 sisältää LeafSize näytteen lohkojen yhteenvedot, ja jokainen
+ * seuraava taso yhdistää kaksi edellisen tason solmua kuten LodPyramid.
+ * Minkä tahansa aikavälin tunnusluvut saadaan yhdistämällä O(log n) solmua
+ * ja käymällä läpi enintään kaksi osittaista lohkoa välin reunoilla.
+ */
+class StatisticsTree
+{
+public:
+    void build(const ChannelData &data);
+    void clear();
+
+    /**
+     * @brief true, jos puu on rakennettu @p data:n nykyiselle näytemäärälle.
+     */
+    bool isBuiltFor(const ChannelData &data) const { return m_built && m_sampleCount == data.size(); }
+
+    /**
+     * @brief Tunnusluvut aikaväliltä [fromMs, toMs].
+     */
+    StatisticsSummary range(const ChannelData &data, qint64 fromMs, qint64 toMs) const;
+
+    /**
+     * @brief Tunnusluvut indeksiväliltä [begin, end).
+     */
+    StatisticsSummary rangeByIndex(const ChannelData &data, qsizetype begin, qsizetype end) const;
+
+    static constexpr qsizetype LeafSize = 64; ///< Näytettä tason 0 solmua kohden.
+
+private:
+    static void scan(const ChannelData &data, qsizetype begin, qsizetype end, StatisticsSummary &summary);
+
+    bool m_built = false;
+    qsizetype m_sampleCount = 0;
+    QList<QVector<StatisticsSummary>> m_levels; // Taso -> solmujen yhteenvedot
+};
+
+#endif // CHANNELSTATISTICS_H
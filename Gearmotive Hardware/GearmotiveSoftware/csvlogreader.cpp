@@ -0,0 +1,556 @@
+#include "csvlogreader.h"
+
+#include <QDateTime>
+#include <QObject>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const char LongHeader[] = "timestamp,name,value,unit";
+const char WidePrefix[] = "timestamp,";
+
+// Paikallisen ajan tunnin alku millisekunteina epochista. Siirtymä haetaan
+// QDateTime:lta vain, kun tunti vaihtuu.
+struct LocalHourCache {
+    qint64 hourKey = std::numeric_limits<qint64>::min();
+    qint64 hourStartMs = 0;
+};
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Kiinteän mittainen numerokenttä, -1 jos mukana on muu merkki
+int parseDigits(const char *p, int count)
+{
+    int value = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!isDigit(p[i])) {
+            return -1;
+        }
+        value = value * 10 + (p[i] - '0');
+    }
+    return value;
+}
+
+// Päivien määrä 1970-01-01:stä gregoriaanisessa kalenterissa
+qint64 daysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2;
+    const qint64 era = (year >= 0 ? year : year - 399) / 400;
+    const int yearOfEra = int(year - era * 400);
+    const int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+// yyyy-MM-ddTHH:mm:ss[.zzz][Z|±HH:mm], kuten Qt::ISODateWithMs
+bool parseIsoTimestamp(const char *begin, const char *end, LocalHourCache &cache, qint64 &result)
+{
+    if (end - begin < 19 || begin[4] != '-' || begin[7] != '-' || begin[10] != 'T'
+        || begin[13] != ':' || begin[16] != ':') {
+        return false;
+    }
+    const int year = parseDigits(begin, 4);
+    const int month = parseDigits(begin + 5, 2);
+    const int day = parseDigits(begin + 8, 2);
+    const int hour = parseDigits(begin + 11, 2);
+    const int minute = parseDigits(begin + 14, 2);
+    const int second = parseDigits(begin + 17, 2);
+    if (year < 0 || month < 1 || month > 12 || day < 1 || day > 31
+        || hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 59) {
+        return false;
+    }
+
+    const char *p = begin + 19;
+    int ms = 0;
+    if (p < end && *p == '.') {
+        const char *fraction = ++p;
+        int scale = 100;
+        while (p < end && isDigit(*p)) {
+            ms += (*p - '0') * scale; // Millisekuntia tarkemmat numerot jäävät pois
+            scale /= 10;
+            ++p;
+        }
+        if (p == fraction) {
+            return false;
+        }
+    }
+
+    const qint64 days = daysFromCivil(year, month, day);
+    const qint64 withinHourMs = (minute * 60 + second) * 1000LL + ms;
+
+    if (p == end) {
+        // Paikallinen aika
+        const qint64 hourKey = days * 24 + hour;
+        if (hourKey != cache.hourKey) {
+            const QDateTime hourStart(QDate(year, month, day), QTime(hour, 0));
+            if (!hourStart.isValid()) {
+                return false;
+            }
+            cache.hourKey = hourKey;
+            cache.hourStartMs = hourStart.toMSecsSinceEpoch();
+        }
+        result = cache.hourStartMs + withinHourMs;
+        return true;
+    }
+
+    int offsetMinutes = 0;
+    if (*p == 'Z' && p + 1 == end) {
+        offsetMinutes = 0;
+    } else if ((*p == '+' || *p == '-') && (end - p == 6 || end - p == 5)) {
+        const int offsetHours = parseDigits(p + 1, 2);
+        const int offsetMins = parseDigits(end - 2, 2);
+        if (offsetHours < 0 || offsetMins < 0 || (end - p == 6 && p[3] != ':')) {
+            return false;
+        }
+        offsetMinutes = (offsetHours * 60 + offsetMins) * (*p == '-' ? -1 : 1);
+    } else {
+        return false;
+    }
+    result = ((days * 24 + hour) * 60 - offsetMinutes) * 60000LL + withinHourMs;
+    return true;
+}
+
+bool parseTimestamp(const char *begin, const char *end, LocalHourCache &cache, qint64 &result)
+{
+    if (parseIsoTimestamp(begin, end, cache, result)) {
+        return true;
+    }
+    // Harvinaiset muodot hoitaa QDateTime
+    const QDateTime timestamp = QDateTime::fromString(QString::fromLatin1(begin, end - begin), Qt::ISODateWithMs);
+    if (!timestamp.isValid()) {
+        return false;
+    }
+    result = timestamp.toMSecsSinceEpoch();
+    return true;
+}
+
+// Desimaaliluku ilman lokaalia. Tavalliset arvot lasketaan tarkasti
+// kokonaislukumantissasta (enintään 2^53) ja kymmenen potenssista
+// (enintään 1e22); muut välitetään QByteArray::toDouble():lle.
+bool parseDouble(const char *begin, const char *end, double &value)
+{
+    static const double POW10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char *p = begin;
+    const bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+        ++p;
+    }
+
+    quint64 mantissa = 0;
+    int significant = 0;
+    int exponent = 0;
+    bool anyDigits = false;
+    while (p < end && isDigit(*p)) {
+        mantissa = mantissa * 10 + quint64(*p - '0');
+        significant += mantissa != 0;
+        anyDigits = true;
+        ++p;
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && isDigit(*p)) {
+            mantissa = mantissa * 10 + quint64(*p - '0');
+            significant += mantissa != 0;
+            --exponent;
+            anyDigits = true;
+            ++p;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E') && anyDigits) {
+        ++p;
+        const bool negativeExponent = p < end && *p == '-';
+        if (p < end && (*p == '-' || *p == '+')) {
+            ++p;
+        }
+        int e = 0;
+        const char *digits = p;
+        while (p < end && isDigit(*p) && e < 10000) {
+            e = e * 10 + (*p - '0');
+            ++p;
+        }
+        if (p == digits) {
+            anyDigits = false;
+        }
+        exponent += negativeExponent ? -e : e;
+    }
+
+    if (anyDigits && p == end && significant <= 19
+        && mantissa <= (quint64(1) << 53) && exponent >= -22 && exponent <= 22) {
+        double result = double(mantissa);
+        result = exponent < 0 ? result / POW10[-exponent] : result * POW10[exponent];
+        value = negative ? -result : result;
+        return true;
+    }
+
+    bool ok = false;
+    value = QByteArray(begin, end - begin).toDouble(&ok);
+    return ok;
+}
+
+// Rivin loppu ilman rivinvaihtoa ja mahdollista CR:ää
+inline const char *lineEnd(const char *line, const char *end, const char *&next)
+{
+    const char *newline = static_cast<const char *>(std::memchr(line, '\n', size_t(end - line)));
+    next = newline ? newline + 1 : end;
+    const char *stop = newline ? newline : end;
+    if (stop > line && stop[-1] == '\r') {
+        --stop;
+    }
+    return stop;
+}
+
+inline const char *findComma(const char *begin, const char *end)
+{
+    const char *comma = static_cast<const char *>(std::memchr(begin, ',', size_t(end - begin)));
+    return comma ? comma : end;
+}
+
+} // namespace
+
+bool CsvLogReader::fail(const QString &error)
+{
+    close();
+    m_error = error;
+    return false;
+}
+
+bool CsvLogReader::open(const QString &filePath)
+{
+    close();
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return fail(m_file.errorString());
+    }
+
+    m_size = m_file.size();
+    if (m_size > 0) {
+        if (const uchar *mapped = m_file.map(0, m_size)) {
+            m_data = reinterpret_cast<const char *>(mapped);
+        } else {
+            m_fallback = m_file.readAll();
+            m_data = m_fallback.constData();
+            m_size = m_fallback.size();
+        }
+    }
+
+    // Otsikko, mahdollinen UTF-8 BOM ohitetaan
+    const char *begin = m_data;
+    const char *end = m_data + m_size;
+    if (m_size >= 3 && std::memcmp(begin, "\xEF\xBB\xBF", 3) == 0) {
+        begin += 3;
+    }
+    const char *next = nullptr;
+    const char *headerEnd = lineEnd(begin, end, next);
+    const QByteArray header(begin, headerEnd - begin);
+
+    if (header == LongHeader) {
+        m_wide = false;
+    } else if (header.startsWith(WidePrefix)) {
+        // Sarakkeet ovat muotoa "nimi [yksikkö]"
+        m_wide = true;
+        const QList<QByteArray> titles = header.split(',');
+        for (qsizetype i = 1; i < titles.size(); ++i) {
+            const QByteArray &title = titles[i];
+            Column column;
+            const qsizetype unitStart = title.lastIndexOf(" [");
+            if (unitStart >= 0 && title.endsWith(']')) {
+                column.name = title.left(unitStart);
+                column.unit = title.mid(unitStart + 2, title.size() - unitStart - 3);
+            } else {
+                column.name = title;
+            }
+            m_columns.append(column);
+        }
+    } else {
+        return fail(QObject::tr("Tiedosto ei ole tunnettu CSV-loki."));
+    }
+
+    // Lohkot alkavat aina rivin alusta
+    qint64 pos = next - m_data;
+    while (pos < m_size) {
+        m_chunkStarts.append(pos);
+        if (m_size - pos <= ChunkSize) {
+            break;
+        }
+        const char *split = m_data + pos + ChunkSize;
+        const char *newline = static_cast<const char *>(std::memchr(split, '\n', size_t(end - split)));
+        pos = newline ? newline + 1 - m_data : m_size;
+    }
+    return true;
+}
+
+void CsvLogReader::close()
+{
+    // Muistiin kuvaus puretaan tiedoston sulkemisen yhteydessä
+    m_file.close();
+    m_fallback.clear();
+    m_data = nullptr;
+    m_size = 0;
+    m_wide = false;
+    m_columns.clear();
+    m_chunkStarts.clear();
+    m_error.clear();
+}
+
+bool CsvLogReader::chunkRange(int index, const char *&begin, const char *&end) const
+{
+    if (index < 0 || index >= m_chunkStarts.size()) {
+        return false;
+    }
+    begin = m_data + m_chunkStarts[index];
+    end = m_data + (index + 1 < m_chunkStarts.size() ? m_chunkStarts[index + 1] : m_size);
+    return true;
+}
+
+CsvLogReader::Chunk CsvLogReader::parseChunk(int index, const QByteArray &channel) const
+{
+    Chunk chunk;
+    const char *begin;
+    const char *end;
+    if (!chunkRange(index, begin, end)) {
+        return chunk;
+    }
+    if (m_wide) {
+        parseWide(begin, end, channel, chunk);
+    } else {
+        parseLong(begin, end, channel, chunk);
+    }
+    return chunk;
+}
+
+QList<CsvLogReader::ChunkSummary> CsvLogReader::indexChunk(int index) const
+{
+    QList<ChunkSummary> summaries;
+    const char *begin;
+    const char *end;
+    if (!chunkRange(index, begin, end)) {
+        return summaries;
+    }
+    if (m_wide) {
+        indexWide(begin, end, summaries);
+    } else {
+        indexLong(begin, end, summaries);
+    }
+    return summaries;
+}
+
+void CsvLogReader::parseLong(const char *begin, const char *end, const QByteArray &channel, Chunk &chunk) const
+{
+    LocalHourCache cache;
+    int current = -1;
+    const char *next = begin;
+    for (const char *line = begin; line < end; line = next) {
+        const char *stop = lineEnd(line, end, next);
+
+        // timestamp,name,value,unit; muut rivit ohitetaan
+        const char *c1 = findComma(line, stop);
+        const char *c2 = c1 < stop ? findComma(c1 + 1, stop) : stop;
+        const char *c3 = c2 < stop ? findComma(c2 + 1, stop) : stop;
+        if (c3 == stop || findComma(c3 + 1, stop) != stop) {
+            continue;
+        }
+
+        // Muiden kanavien riveiltä ei jäsennetä aikaleimaa eikä arvoa
+        const char *name = c1 + 1;
+        const qsizetype nameSize = c2 - name;
+        if (!channel.isEmpty()
+            && (channel.size() != nameSize || std::memcmp(channel.constData(), name, size_t(nameSize)) != 0)) {
+            continue;
+        }
+
+        qint64 timestampMs;
+        double value;
+        if (!parseTimestamp(line, c1, cache, timestampMs) || !parseDouble(c2 + 1, c3, value)) {
+            continue;
+        }
+
+        // Kanavia on vähän ja ne vuorottelevat, joten lineaarinen haku riittää
+        const auto matches = [&](int i) {
+            return chunk[i].name.size() == nameSize && std::memcmp(chunk[i].name.constData(), name, size_t(nameSize)) == 0;
+        };
+        if (current < 0 || !matches(current)) {
+            current = -1;
+            for (int i = 0; i < chunk.size(); ++i) {
+                if (matches(i)) {
+                    current = i;
+                    break;
+                }
+            }
+            if (current < 0) {
+                ChunkChannel part;
+                part.name = QByteArray(name, nameSize);
+                part.unit = QByteArray(c3 + 1, stop - c3 - 1).trimmed();
+                chunk.append(part);
+                current = int(chunk.size()) - 1;
+            }
+        }
+        chunk[current].timestamps.append(timestampMs);
+        chunk[current].values.append(value);
+    }
+}
+
+void CsvLogReader::parseWide(const char *begin, const char *end, const QByteArray &channel, Chunk &chunk) const
+{
+    // Suodatettaessa tulokseen tulee vain valitun sarakkeen kanava
+    int only = -1;
+    for (int i = 0; i < m_columns.size(); ++i) {
+        if (!channel.isEmpty() && m_columns[i].name != channel) {
+            continue;
+        }
+        if (!channel.isEmpty()) {
+            only = i;
+        }
+        ChunkChannel part;
+        part.name = m_columns[i].name;
+        part.unit = m_columns[i].unit;
+        chunk.append(part);
+    }
+    if (!channel.isEmpty() && only < 0) {
+        return;
+    }
+
+    LocalHourCache cache;
+    const char *next = begin;
+    for (const char *line = begin; line < end; line = next) {
+        const char *stop = lineEnd(line, end, next);
+
+        const char *cell = findComma(line, stop);
+        qint64 timestampMs;
+        if (cell == stop || !parseTimestamp(line, cell, cache, timestampMs)) {
+            continue;
+        }
+
+        // Väärän sarakemäärän rivit (esim. katkennut viimeinen rivi) ohitetaan kokonaan
+        qsizetype commas = 0;
+        for (const char *p = cell; p < stop; p = findComma(p + 1, stop)) {
+            ++commas;
+        }
+        if (commas != m_columns.size()) {
+            continue;
+        }
+
+        int column = 0;
+        for (const char *p = cell; p < stop; ++column) {
+            const char *cellEnd = findComma(p + 1, stop);
+            double value;
+            if ((only < 0 || column == only) && cellEnd != p + 1 && parseDouble(p + 1, cellEnd, value)) {
+                ChunkChannel &part = chunk[only < 0 ? column : 0];
+                part.timestamps.append(timestampMs);
+                part.values.append(value);
+            }
+            p = cellEnd;
+        }
+    }
+}
+
+void CsvLogReader::indexLong(const char *begin, const char *end, QList<ChunkSummary> &summaries) const
+{
+    // Aikaleima jäsennetään vain kanavan ensimmäiseltä ja viimeiseltä riviltä
+    LocalHourCache cache;
+    QVector<const char *> lastLines;
+    int current = -1;
+    const char *next = begin;
+    for (const char *line = begin; line < end; line = next) {
+        const char *stop = lineEnd(line, end, next);
+        const char *c1 = findComma(line, stop);
+        const char *c2 = c1 < stop ? findComma(c1 + 1, stop) : stop;
+        const char *c3 = c2 < stop ? findComma(c2 + 1, stop) : stop;
+        if (c3 == stop || findComma(c3 + 1, stop) != stop) {
+            continue;
+        }
+
+        const char *name = c1 + 1;
+        const qsizetype nameSize = c2 - name;
+        const auto matches = [&](int i) {
+            return summaries[i].name.size() == nameSize
+                && std::memcmp(summaries[i].name.constData(), name, size_t(nameSize)) == 0;
+        };
+        if (current < 0 || !matches(current)) {
+            current = -1;
+            for (int i = 0; i < summaries.size(); ++i) {
+                if (matches(i)) {
+                    current = i;
+                    break;
+                }
+            }
+            if (current < 0) {
+                ChunkSummary summary;
+                if (!parseTimestamp(line, c1, cache, summary.firstMs)) {
+                    continue;
+                }
+                summary.name = QByteArray(name, nameSize);
+                summary.unit = QByteArray(c3 + 1, stop - c3 - 1).trimmed();
+                summaries.append(summary);
+                lastLines.append(line);
+                current = int(summaries.size()) - 1;
+            }
+        }
+        ++summaries[current].count;
+        lastLines[current] = line;
+    }
+
+    for (int i = 0; i < summaries.size(); ++i) {
+        const char *line = lastLines[i];
+        const char *unused;
+        const char *stop = lineEnd(line, end, unused);
+        if (!parseTimestamp(line, findComma(line, stop), cache, summaries[i].lastMs)) {
+            summaries[i].lastMs = summaries[i].firstMs;
+        }
+    }
+}
+
+void CsvLogReader::indexWide(const char *begin, const char *end, QList<ChunkSummary> &summaries) const
+{
+    QVector<const char *> firstLines(m_columns.size(), nullptr);
+    QVector<const char *> lastLines(m_columns.size(), nullptr);
+    QVector<quint64> counts(m_columns.size(), 0);
+
+    const char *next = begin;
+    for (const char *line = begin; line < end; line = next) {
+        const char *stop = lineEnd(line, end, next);
+        const char *cell = findComma(line, stop);
+        if (cell == stop) {
+            continue;
+        }
+
+        int column = 0;
+        const char *p = cell;
+        for (; p < stop && column < m_columns.size(); ++column) {
+            const char *cellEnd = findComma(p + 1, stop);
+            if (cellEnd != p + 1) {
+                if (!firstLines[column]) {
+                    firstLines[column] = line;
+                }
+                lastLines[column] = line;
+                ++counts[column];
+            }
+            p = cellEnd;
+        }
+    }
+
+    LocalHourCache cache;
+    const auto lineTimestamp = [&](const char *line, qint64 &timestampMs) {
+        const char *unused;
+        const char *stop = lineEnd(line, end, unused);
+        return parseTimestamp(line, findComma(line, stop), cache, timestampMs);
+    };
+    for (int i = 0; i < m_columns.size(); ++i) {
+        ChunkSummary summary;
+        if (counts[i] == 0 || !lineTimestamp(firstLines[i], summary.firstMs)
+            || !lineTimestamp(lastLines[i], summary.lastMs)) {
+            continue;
+        }
+        summary.name = m_columns[i].name;
+        summary.unit = m_columns[i].unit;
+        summary.count = counts[i];
+        summaries.append(summary);
+    }
+}
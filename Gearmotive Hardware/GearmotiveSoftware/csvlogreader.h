@@ -0,0 +1,90 @@
+#ifndef CSVLOGREADER_H
+#define CSVLOGREADER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+/**
+ * @class CsvLogReader
+ * @brief Lukee CSV-lokin muistiin kuvattuna, lohkoittain rinnakkain jäsennettävissä.
+ *
+ * open() kuvaa tiedoston muistiin, tunnistaa rivimuodon otsikosta
+ * (ks. CsvLogWriter::Layout) ja jakaa datan rivinvaihtoihin tasattuihin
+ * lohkoihin. indexChunk() ja parseChunk() eivät muuta lukijan tilaa, joten
+ * lohkoja voi käsitellä eri säikeissä yhtä aikaa (esim. QtConcurrent::mapped).
+ *
+ * indexChunk() käy lohkon läpi jäsentämättä arvoja ja kertoo, mitkä kanavat
+ * lohkossa esiintyvät ja millä aikavälillä. Sen perusteella yksittäisen
+ * kanavan voi myöhemmin jäsentää vain niistä lohkoista, joissa se on.
+ *
+ * Aikaleimat ja luvut jäsennetään käsin kirjoitetuilla jäsentimillä;
+ * QDateTime:a käytetään vain paikallisen ajan siirtymän hakemiseen kerran
+ * tuntia kohden.
+ */
+class CsvLogReader
+{
+public:
+    // Yhden lohkon kanavat siinä järjestyksessä kuin ne lohkossa esiintyivät
+    struct ChunkChannel {
+        QByteArray name;
+        QByteArray unit;
+        QVector<qint64> timestamps;
+        QVector<double> values;
+    };
+    using Chunk = QList<ChunkChannel>;
+
+    // Kanavan esiintymä yhdessä lohkossa
+    struct ChunkSummary {
+        QByteArray name;
+        QByteArray unit;
+        quint64 count = 0;
+        qint64 firstMs = 0;
+        qint64 lastMs = 0;
+    };
+
+    static constexpr qint64 ChunkSize = 4 * 1024 * 1024;
+
+    bool open(const QString &filePath);
+    void close();
+    QString errorString() const { return m_error; }
+
+    int chunkCount() const { return int(m_chunkStarts.size()); }
+
+    /**
+     * @brief Jäsentää lohkon @p index. Virheelliset rivit ohitetaan.
+     * @param channel Jos annettu, vain tämän nimisen kanavan näytteet.
+     */
+    Chunk parseChunk(int index, const QByteArray &channel = QByteArray()) const;
+
+    /**
+     * @brief Lohkon kanavat, näytemäärät ja aikavälit. Arvoja ei jäsennetä.
+     */
+    QList<ChunkSummary> indexChunk(int index) const;
+
+private:
+    struct Column {
+        QByteArray name;
+        QByteArray unit;
+    };
+
+    bool chunkRange(int index, const char *&begin, const char *&end) const;
+    void parseLong(const char *begin, const char *end, const QByteArray &channel, Chunk &chunk) const;
+    void parseWide(const char *begin, const char *end, const QByteArray &channel, Chunk &chunk) const;
+    void indexLong(const char *begin, const char *end, QList<ChunkSummary> &summaries) const;
+    void indexWide(const char *begin, const char *end, QList<ChunkSummary> &summaries) const;
+    bool fail(const QString &error);
+
+    QFile m_file;
+    QByteArray m_fallback; // Jos muistiin kuvaus ei onnistu
+    const char *m_data = nullptr;
+    qint64 m_size = 0;
+    bool m_wide = false;
+    QList<Column> m_columns; // Vain leveä muoto
+    QVector<qint64> m_chunkStarts;
+    QString m_error;
+};
+
+#endif // CSVLOGREADER_H
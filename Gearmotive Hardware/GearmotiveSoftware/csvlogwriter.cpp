@@ -0,0 +1,215 @@
+#include "csvlogwriter.h"
+
+#include <QDateTime>
+
+CsvLogWriter::CsvLogWriter(Layout layout)
+    : m_layout(layout)
+{
+}
+
+bool CsvLogWriter::open(const QString &filePath)
+{
+    m_errorString.clear();
+    m_columnTypes.clear();
+    m_column.fill(-1);
+    if (m_layout == Layout::Wide) {
+        // Rekisterissä ovat myös laskennalliset kanavat, joten sarake on jokaiselle
+        // kanavalle, joka voi tulla lokitettavaksi
+        for (SensorType type : registeredSensors()) {
+            m_column[quint8(type)] = int(m_columnTypes.size());
+            m_columnTypes.append(type);
+        }
+        m_row.fill(0.0, m_columnTypes.size());
+        m_rowSet.fill(false, m_columnTypes.size());
+    }
+    m_rowPending = false;
+    m_skippedSamples = 0;
+
+    // Olemassa olevaan tiedostoon jatketaan vain, jos sarakkeet ovat samat
+    const QByteArray headerLine = header();
+    if (!matchesHeader(filePath, headerLine)) {
+        return false;
+    }
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        return false;
+    }
+
+    m_buffer.clear();
+    m_buffer.reserve(WriteThreshold * 2);
+    m_cachedSecond = -1;
+
+    // Kirjoitetaan otsikkorivi, jos tiedosto on tyhjä.
+    if (m_file.size() == 0) {
+        m_buffer.append(headerLine);
+    }
+    return true;
+}
+
+QByteArray CsvLogWriter::header() const
+{
+    if (m_layout == Layout::Long) {
+        return QByteArrayLiteral("timestamp,name,value,unit\n");
+    }
+
+    QByteArray line = QByteArrayLiteral("timestamp");
+    for (SensorType type : m_columnTypes) {
+        const SensorInfo &info = sensorInfo(type);
+        line += ',' + info.name.toUtf8();
+        if (!info.unit.isEmpty()) {
+            line += " [" + info.unit.toUtf8() + ']';
+        }
+    }
+    return line + '\n';
+}
+
+bool CsvLogWriter::matchesHeader(const QString &filePath, const QByteArray &header)
+{
+    QFile existing(filePath);
+    if (!existing.exists() || existing.size() == 0) {
+        return true;
+    }
+    if (!existing.open(QIODevice::ReadOnly)) {
+        m_errorString = existing.errorString();
+        return false;
+    }
+    if (existing.readLine().trimmed() != header.trimmed()) {
+        m_errorString = QStringLiteral("The existing file has a different column layout");
+        return false;
+    }
+    return true;
+}
+
+bool CsvLogWriter::write(const SensorSample *samples, int count)
+{
+    if (m_layout == Layout::Wide) {
+        writeWide(samples, count);
+    } else {
+        writeLong(samples, count);
+    }
+
+    // Isot erät kirjoitetaan jo ennen flush()-kutsua, jotta puskuri ei kasva rajatta
+    if (m_buffer.size() >= WriteThreshold) {
+        return flush();
+    }
+    return true;
+}
+
+bool CsvLogWriter::flush()
+{
+    if (!m_buffer.isEmpty()) {
+        const qint64 written = m_file.write(m_buffer);
+        m_buffer.clear();
+        if (written < 0) {
+            return false;
+        }
+    }
+    return m_file.flush();
+}
+
+bool CsvLogWriter::sync()
+{
+    return flush() && syncFile(m_file);
+}
+
+bool CsvLogWriter::close()
+{
+    if (!m_file.isOpen()) {
+        return true;
+    }
+    const bool ok = flush();
+    m_file.close();
+    return ok;
+}
+
+QString CsvLogWriter::errorString() const
+{
+    return m_errorString.isEmpty() ? m_file.errorString() : m_errorString;
+}
+
+void CsvLogWriter::writeLong(const SensorSample *samples, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const SensorSample &sample = samples[i];
+        const Labels &l = labels(sample.type);
+        appendTimestamp(sample.timestampMs);
+        m_buffer.append(l.name);
+        m_buffer.append(QByteArray::number(sample.value, 'f', sensorInfo(sample.type).decimals));
+        m_buffer.append(l.unit);
+    }
+}
+
+void CsvLogWriter::writeWide(const SensorSample *samples, int count)
+{
+    // Yhden eräkehyksen näytteillä on sama aikaleima; uusi rivi alkaa, kun
+    // aikaleima vaihtuu tai sama anturi toistuu
+    for (int i = 0; i < count; ++i) {
+        const SensorSample &sample = samples[i];
+        const int column = m_column[quint8(sample.type)];
+        if (column < 0) {
+            ++m_skippedSamples; // Rekisteröity vasta lokituksen alettua
+            continue;
+        }
+        if (m_rowPending && (sample.timestampMs != m_rowTimestamp || m_rowSet[column])) {
+            appendRow();
+        }
+        m_rowTimestamp = sample.timestampMs;
+        m_rowPending = true;
+        m_row[column] = sample.value;
+        m_rowSet[column] = true;
+    }
+
+    // Erä sisältää kokonaisia vastaanotettuja eriä, joten kierros ei jatku seuraavaan kutsuun
+    if (m_rowPending) {
+        appendRow();
+    }
+}
+
+void CsvLogWriter::appendRow()
+{
+    appendTimestamp(m_rowTimestamp);
+    for (int column = 0; column < m_columnTypes.size(); ++column) {
+        m_buffer.append(',');
+        if (m_rowSet[column]) {
+            m_buffer.append(QByteArray::number(m_row[column], 'f', sensorInfo(m_columnTypes[column]).decimals));
+            m_rowSet[column] = false;
+        }
+    }
+    m_buffer.append('\n');
+    m_rowPending = false;
+}
+
+void CsvLogWriter::appendTimestamp(qint64 timestampMs)
+{
+    // Sama muoto kuin Qt::ISODateWithMs paikallisessa ajassa. Aikavyöhykkeen
+    // siirtymä ei voi muuttua kesken sekunnin, joten etuliite voidaan käyttää uudelleen.
+    const qint64 second = timestampMs >= 0 ? timestampMs / 1000 : (timestampMs - 999) / 1000;
+    if (second != m_cachedSecond) {
+        m_cachedSecond = second;
+        m_cachedPrefix = QDateTime::fromMSecsSinceEpoch(second * 1000)
+                             .toString(QStringLiteral("yyyy-MM-ddTHH:mm:ss.")).toLatin1();
+    }
+
+    const int ms = int(timestampMs - second * 1000);
+    const char digits[3] = { char('0' + ms / 100), char('0' + ms / 10 % 10), char('0' + ms % 10) };
+    m_buffer.append(m_cachedPrefix);
+    m_buffer.append(digits, 3);
+}
+
+const CsvLogWriter::Labels &CsvLogWriter::labels(SensorType type)
+{
+    Labels &l = m_labels[quint8(type)];
+    if (!l.cached) {
+        const SensorInfo &info = sensorInfo(type);
+        l.name = ',' + info.name.toUtf8() + ',';
+        l.unit = ',' + info.unit.toUtf8() + '\n';
+        l.cached = true;
+    }
+    return l;
+}
+
+qint64 CsvLogWriter::bytesWritten() const
+{
+    return m_file.size() + m_buffer.size();
+}
@@ -0,0 +1,78 @@
+#ifndef CSVLOGWRITER_H
+#define CSVLOGWRITER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QVector>
+#include <array>
+#include "logwriter.h"
+
+/**
+ * @class CsvLogWriter
+ * @brief Kirjoittaa näytteet CSV-muodossa.
+ *
+ * Layout::Long kirjoittaa rivin näytettä kohden: "timestamp,name,value,unit".
+ * Layout::Wide kirjoittaa rivin mittauskierrosta (samaa aikaleimaa) kohden ja
+ * sarakkeen jokaiselle rekisteröidylle kanavalle, myös laskennallisille;
+ * yksiköt ovat vain otsikossa muodossa "nimi [yksikkö]". Puuttuva arvo
+ * jätetään tyhjäksi. Avauksen jälkeen rekisteröityjen kanavien näytteet
+ * ohitetaan ja lasketaan skippedSamples()-arvoon.
+ *
+ * Rivit muotoillaan suoraan UTF-8-tavupuskuriin. Aikaleiman päivämäärä- ja
+ * kellonaikaosa muotoillaan vain kerran sekunnissa, ja anturin nimi ja
+ * yksikkö haetaan valmiiksi koodattuina tyyppitavun mukaan.
+ */
+class CsvLogWriter : public LogWriter
+{
+public:
+    enum class Layout {
+        Long, ///< Rivi näytettä kohden.
+        Wide  ///< Rivi mittauskierrosta kohden, sarake anturia kohden.
+    };
+
+    explicit CsvLogWriter(Layout layout = Layout::Long);
+
+    bool open(const QString &filePath) override;
+    bool write(const SensorSample *samples, int count) override;
+    bool flush() override;
+    bool sync() override;
+    bool close() override;
+    QString errorString() const override;
+    qint64 bytesWritten() const override;
+    quint64 skippedSamples() const override { return m_skippedSamples; }
+
+private:
+    struct Labels {
+        QByteArray name; // ",nimi,"
+        QByteArray unit; // ",yksikkö\n"
+        bool cached = false;
+    };
+
+    QByteArray header() const;
+    bool matchesHeader(const QString &filePath, const QByteArray &header);
+    void writeLong(const SensorSample *samples, int count);
+    void writeWide(const SensorSample *samples, int count);
+    void appendRow();
+    void appendTimestamp(qint64 timestampMs);
+    const Labels &labels(SensorType type);
+
+    static constexpr int WriteThreshold = 64 * 1024;
+    Layout m_layout;
+    QString m_errorString;
+    QFile m_file;
+    QByteArray m_buffer;
+    std::array<Labels, 256> m_labels;
+    qint64 m_cachedSecond = -1;
+    QByteArray m_cachedPrefix; // "yyyy-MM-ddTHH:mm:ss."
+
+    // Layout::Wide: sarakkeet avaushetken anturirekisterin mukaan
+    std::array<int, 256> m_column;  // Tyyppitavu -> sarake, -1 = ei saraketta
+    QVector<SensorType> m_columnTypes;
+    QVector<double> m_row;
+    QVector<bool> m_rowSet;
+    qint64 m_rowTimestamp = 0;
+    bool m_rowPending = false;
+    quint64 m_skippedSamples = 0;
+};
+
+#endif // CSVLOGWRITER_H
@@ -1,6 +1,9 @@
 #include "datalogger.h"
+#include "binarylogwriter.h"
 #include <QDateTime>
+#include <QDeadlineTimer>
 #include <QDebug>
+#include <QFileInfo>
 
 DataLogger::DataLogger(QObject *parent) : QObject(parent)
 {
@@ -16,6 +19,51 @@ bool DataLogger::isLogging() const
     return m_isLogging;
 }
 
+void DataLogger::setFlushPolicy(const LogFlushPolicy &policy)
+{
+    m_nextPolicy = policy;
+}
+
+LogFlushPolicy DataLogger::flushPolicy() const
+{
+    return m_nextPolicy;
+}
+
+void DataLogger::setRotationPolicy(const LogRotationPolicy &policy)
+{
+    m_nextRotation = policy;
+}
+
+LogRotationPolicy DataLogger::rotationPolicy() const
+{
+    return m_nextRotation;
+}
+
+void DataLogger::setCsvLayout(CsvLogWriter::Layout layout)
+{
+    m_nextCsvLayout = layout;
+}
+
+CsvLogWriter::Layout DataLogger::csvLayout() const
+{
+    return m_nextCsvLayout;
+}
+
+std::unique_ptr<LogWriter> DataLogger::createWriter(const QString &filePath, CsvLogWriter::Layout csvLayout)
+{
+    // Formaatti valitaan tiedostopäätteen mukaan
+    if (filePath.endsWith(QLatin1String(".gmlog"), Qt::CaseInsensitive)) {
+        return std::make_unique<BinaryLogWriter>();
+    }
+    return std::make_unique<CsvLogWriter>(csvLayout);
+}
+
+quint64 DataLogger::droppedSamples() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_droppedSamples;
+}
+
 bool DataLogger::startLogging(const QString &filePath)
 {
     if (m_isLogging) {
@@ -23,22 +71,60 @@ bool DataLogger::startLogging(const QString &filePath)
         stopLogging();
     }
 
-    m_logFile.setFileName(filePath);
-    if (!m_logFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Append)) {
-        qWarning() << "Could not open log file for writing:" << m_logFile.errorString();
-        emit errorOccurred(QString("Could not open log file for writing: %1").arg(m_logFile.errorString()));
-        return false;
+    // Samaan tiedostoon aloitettu lokitus jatkaa aiempaa istuntoa uusina osina
+    LogSession session;
+    const QString format = filePath.endsWith(QLatin1String(".gmlog"), Qt::CaseInsensitive)
+        ? QStringLiteral("gmlog") : QStringLiteral("csv");
+    const QString manifestPath = LogSession::manifestPath(filePath);
+    if (QFileInfo::exists(manifestPath)) {
+        QString error;
+        bool ok = session.load(manifestPath, &error);
+        if (ok && session.format != format) {
+            error = QStringLiteral("The existing session uses the %1 format").arg(session.format);
+            ok = false;
+        }
+        if (!ok) {
+            qWarning() << "Could not continue log session" << manifestPath << ":" << error;
+            emit errorOccurred(QString("Could not continue log session %1: %2").arg(manifestPath, error));
+            return false;
+        }
+    } else {
+        session.format = format;
+        session.startedMs = QDateTime::currentMSecsSinceEpoch();
     }
 
-    m_logStream.setDevice(&m_logFile);
+    const QString segmentPath = LogSession::unusedSegmentPath(filePath, int(session.segments.size()) + 1);
+    m_csvLayout = m_nextCsvLayout;
+    m_writer = createWriter(segmentPath, m_csvLayout);
+    if (!m_writer->open(segmentPath)) {
+        const QString error = m_writer->errorString();
+        m_writer.reset();
+        qWarning() << "Could not open log file for writing:" << error;
+        emit errorOccurred(QString("Could not open log file for writing: %1").arg(error));
+        return false;
+    }
 
-    // Kirjoitetaan otsikkorivi, jos tiedosto on tyhjä.
-    if (m_logFile.size() == 0) {
-        m_logStream << "timestamp,name,value,unit\n";
+    {
+        QMutexLocker lock(&m_mutex);
+        m_policy = m_nextPolicy;
+        m_front.clear();
+        m_front.reserve(4096);
+        m_droppedSamples = 0;
+        m_stopRequested = false;
+        m_accepting = true;
     }
 
+    m_rotation = m_nextRotation;
+    m_firstSegmentPath = filePath;
+    m_session = std::move(session);
+    beginSegment(segmentPath);
+
+    m_writerThread = QThread::create([this]() { writerLoop(); });
+    m_writerThread->setObjectName(QStringLiteral("DataLogger"));
+    m_writerThread->start(QThread::LowPriority);
+
     m_isLogging = true;
-    qDebug() << "Logging started to" << filePath;
+    qDebug() << "Logging started to" << segmentPath;
     emit loggingStatusChanged(true, filePath);
     return true;
 }
@@ -46,37 +132,293 @@ bool DataLogger::startLogging(const QString &filePath)
 void DataLogger::stopLogging()
 {
     if (m_isLogging) {
-        m_logFile.close();
+        {
+            QMutexLocker lock(&m_mutex);
+            m_accepting = false;
+            m_stopRequested = true;
+        }
+        m_wake.wakeOne();
+
+        // Kirjoitussäie tyhjentää puskurit ja sulkee tiedoston ennen päättymistään
+        m_writerThread->wait();
+        delete m_writerThread;
+        m_writerThread = nullptr;
+        m_writer.reset();
+
         m_isLogging = false;
         qDebug() << "Logging stopped.";
         emit loggingStatusChanged(false, "");
     }
 }
 
-void DataLogger::logData(const SensorData &data)
+void DataLogger::logData(const SensorSample &sample)
+{
+    logSamples({sample});
+}
+
+void DataLogger::logSamples(const QList<SensorSample> &samples)
+{
+    bool wake = false;
+    {
+        QMutexLocker lock(&m_mutex);
+        if (!m_accepting) {
+            return;
+        }
+
+        const qsizetype room = m_policy.maxBufferedSamples - m_front.size();
+        const qsizetype accepted = qMin<qsizetype>(samples.size(), qMax<qsizetype>(room, 0));
+        if (accepted == samples.size()) {
+            m_front.append(samples);
+        } else {
+            for (qsizetype i = 0; i < accepted; ++i) {
+                m_front.append(samples.at(i));
+            }
+        }
+        m_droppedSamples += quint64(samples.size() - accepted);
+
+        wake = batchReady();
+    }
+    if (wake) {
+        m_wake.wakeOne();
+    }
+}
+
+bool DataLogger::batchReady() const
+{
+    if (m_policy.flushIntervalMs == 0) {
+        return !m_front.isEmpty();
+    }
+    return m_policy.flushSamples > 0 && m_front.size() >= m_policy.flushSamples;
+}
+
+void DataLogger::writerLoop()
 {
-    if (!m_isLogging || !m_logFile.isOpen()) {
-        return;
+    LogFlushPolicy policy;
+    {
+        QMutexLocker lock(&m_mutex);
+        policy = m_policy;
     }
 
-    // Muunnetaan arvo merkkijonoksi ilman yksikköä, koska yksikkö on omassa sarakkeessaan
-    QString valueString = data.value.toString();
-    
-    // Poistetaan mahdollinen yksikkö value-kentästä, jos se on sinne vahingossa päätynyt
-    // (esim. "25.5 C" -> "25.5")
-    // Tämä on vain varmistus, parsePayloadin tulisi palauttaa pelkkä numero QVariantissa
-    valueString.remove(data.unit.trimmed());
-    valueString = valueString.trimmed();
+    const auto flushTimer = [&policy]() {
+        return policy.flushIntervalMs > 0 ? QDeadlineTimer(policy.flushIntervalMs) : QDeadlineTimer(QDeadlineTimer::Forever);
+    };
+    const auto syncTimer = [&policy]() {
+        return policy.syncIntervalMs > 0 ? QDeadlineTimer(policy.syncIntervalMs) : QDeadlineTimer(QDeadlineTimer::Forever);
+    };
+
+    QDeadlineTimer flushDeadline = flushTimer();
+    QDeadlineTimer syncDeadline = syncTimer();
+    QDeadlineTimer manifestDeadline(QDeadlineTimer::Forever); // Käynnissä, kun manifesti on jäljessä
+    qsizetype unflushed = 0;
+    bool unsynced = false;
+    bool failed = false;
+    quint64 reportedDrops = 0;
+    quint64 reportedSkips = 0; // Nykyisen kirjoittajan ohittamat
+    QString error; // Asetetaan, jos virhe ei ole kirjoittajan oma
+
+    for (;;) {
+        bool stop;
+        quint64 drops;
+        {
+            // Odotetaan seuraavaan määräaikaan asti, jotta data muotoillaan ja
+            // kirjoitetaan isoina erinä, ellei näytemäärä tai lopetus herätä aiemmin
+            QMutexLocker lock(&m_mutex);
+            const QDeadlineTimer deadline = qMin(qMin(flushDeadline, syncDeadline), manifestDeadline);
+            while (!m_stopRequested && !batchReady()) {
+                if (!m_wake.wait(&m_mutex, deadline)) {
+                    break;
+                }
+            }
+            // Vaihdetaan puskurit: vastaanottaja jatkaa tyhjään, ja täysi käsitellään ilman lukkoa
+            m_front.swap(m_back);
+            stop = m_stopRequested;
+            drops = m_droppedSamples;
+        }
+
+        if (!m_back.isEmpty() && !failed) {
+            failed = !m_writer->write(m_back.constData(), int(m_back.size()));
+            unflushed += m_back.size();
+            summarize(m_back);
+
+            // Kirjoittajan ohittamat näytteet lasketaan pudotettuihin, mutta
+            // raportoidaan erikseen puskurin ylivuodosta
+            const quint64 skips = m_writer->skippedSamples();
+            if (skips != reportedSkips) {
+                qWarning() << "Log file has no column for" << skips - reportedSkips << "samples, they were dropped";
+                QMutexLocker lock(&m_mutex);
+                m_droppedSamples += skips - reportedSkips;
+                drops += skips - reportedSkips;
+                reportedDrops += skips - reportedSkips;
+                reportedSkips = skips;
+            }
+        }
+        m_back.clear(); // Kapasiteetti säilyy seuraavaa kierrosta varten
+
+        const bool flushDue = stop || policy.flushIntervalMs == 0 || flushDeadline.hasExpired()
+            || (policy.flushSamples > 0 && unflushed >= policy.flushSamples);
+        if (unflushed > 0 && flushDue && !failed) {
+            failed = !m_writer->flush();
+            unflushed = 0;
+            unsynced = true;
+            if (manifestDeadline.isForever()) {
+                manifestDeadline.setRemainingTime(ManifestIntervalMs);
+            }
+        }
+        if (flushDue) {
+            flushDeadline = flushTimer();
+        }
 
+        if (policy.syncIntervalMs > 0 && (stop || syncDeadline.hasExpired())) {
+            if (unsynced && !failed) {
+                failed = !m_writer->sync();
+                unsynced = false;
+            }
+            syncDeadline = syncTimer();
+        }
 
-    QString timestamp = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
-    m_logStream << timestamp << ","
-                << data.name << ","
-                << valueString << ","
-                << data.unit.trimmed() << "\n";
+        // Keskeneräisen osan aikaväli ja näytemäärät päivitetään manifestiin
+        // kirjoitetun datan perässä, jotta katselija näkee ne jo lokituksen aikana
+        if (!failed && manifestDeadline.hasExpired()) {
+            saveSegment();
+            manifestDeadline = QDeadlineTimer(QDeadlineTimer::Forever);
+        }
 
-    // Varmistetaan, että data kirjoitetaan heti käyttöjärjestelmän puskuriin.
-    // Tämä minimoi datan menetyksen ohjelman kaatuessa, koska data ei jää
-    // sovelluksen omaan puskuriin.
-    m_logStream.flush();
-} 
\ No newline at end of file
+        // Osa vaihdetaan erien välissä, joten osa voi ylittää rajan yhden erän verran
+        if (!failed && !stop && rotationDue()) {
+            failed = !rotateSegment(&error);
+            reportedSkips = 0;
+            unflushed = 0;
+            unsynced = false;
+            manifestDeadline = QDeadlineTimer(QDeadlineTimer::Forever);
+        }
+
+        if (failed) {
+            // Lokitus lopetetaan käyttöliittymän säikeessä, kun tämä säie on päättynyt
+            if (error.isEmpty()) {
+                error = QString("Writing the log file failed: %1").arg(m_writer->errorString());
+            }
+            emit errorOccurred(error);
+            {
+                QMutexLocker lock(&m_mutex);
+                m_accepting = false;
+            }
+            QThread *self = QThread::currentThread();
+            QMetaObject::invokeMethod(this, [this, self]() {
+                if (m_writerThread == self) {
+                    stopLogging();
+                }
+            }, Qt::QueuedConnection);
+        }
+
+        if (drops != reportedDrops) {
+            qWarning() << "Log buffer overflow, dropped" << drops - reportedDrops << "samples";
+            reportedDrops = drops;
+        }
+
+        if (stop || failed) {
+            break;
+        }
+    }
+
+    // Kirjoitusvirheen jälkeen osa jää keskeneräiseksi, jolloin katselija lukee
+    // sen palautuksen kautta. Seuraavan osan avausvirhe ei koske nykyistä osaa.
+    const bool writerFailed = failed && error.isEmpty();
+    const bool closed = m_writer->close();
+    if (!closed && !failed) {
+        emit errorOccurred(QString("Closing the log file failed: %1").arg(m_writer->errorString()));
+    }
+    finishSegment(closed && !writerFailed);
+}
+
+void DataLogger::beginSegment(const QString &filePath)
+{
+    m_segmentPath = filePath;
+    for (quint8 type : std::as_const(m_segmentChannelOrder)) {
+        m_segmentChannels[type] = LogChannelSummary();
+    }
+    m_segmentChannelOrder.clear();
+
+    LogSegment segment;
+    segment.fileName = QFileInfo(filePath).fileName();
+    m_session.segments.append(segment);
+
+    QString error;
+    if (!m_session.save(LogSession::manifestPath(m_firstSegmentPath), &error)) {
+        qWarning() << "Could not write session manifest:" << error;
+    }
+}
+
+void DataLogger::summarize(const QVector<SensorSample> &samples)
+{
+    LogSegment &segment = m_session.segments.last();
+    for (const SensorSample &sample : samples) {
+        if (m_segmentChannelOrder.isEmpty()) {
+            segment.firstMs = sample.timestampMs;
+            segment.lastMs = sample.timestampMs;
+        }
+        LogChannelSummary &channel = m_segmentChannels[quint8(sample.type)];
+        if (channel.count == 0) {
+            const SensorInfo &info = sensorInfo(sample.type);
+            channel.type = quint8(sample.type);
+            channel.name = info.name;
+            channel.unit = info.unit;
+            m_segmentChannelOrder.append(channel.type);
+        }
+        channel.add(sample.timestampMs, sample.value);
+        segment.firstMs = qMin(segment.firstMs, sample.timestampMs);
+        segment.lastMs = qMax(segment.lastMs, sample.timestampMs);
+    }
+}
+
+bool DataLogger::rotationDue() const
+{
+    if (m_rotation.maxSegmentBytes > 0 && m_writer->bytesWritten() >= m_rotation.maxSegmentBytes) {
+        return true;
+    }
+    const LogSegment &segment = m_session.segments.last();
+    return m_rotation.maxSegmentDurationMs > 0 && !m_segmentChannelOrder.isEmpty()
+        && segment.lastMs - segment.firstMs >= m_rotation.maxSegmentDurationMs;
+}
+
+bool DataLogger::rotateSegment(QString *error)
+{
+    // Seuraava osa avataan ennen nykyisen sulkemista: jos avaus epäonnistuu,
+    // nykyinen osa jää auki ja päätetään kerran, kun lokitus lopetetaan
+    const QString nextPath = LogSession::unusedSegmentPath(m_firstSegmentPath, int(m_session.segments.size()) + 1);
+    std::unique_ptr<LogWriter> next = createWriter(nextPath, m_csvLayout);
+    if (!next->open(nextPath)) {
+        *error = QString("Could not open log file for writing: %1").arg(next->errorString());
+        return false;
+    }
+
+    const bool closed = m_writer->close();
+    if (!closed) {
+        qWarning() << "Closing log segment" << m_segmentPath << "failed:" << m_writer->errorString();
+    }
+    finishSegment(closed);
+    m_writer = std::move(next);
+    qDebug() << "Log continues in" << nextPath;
+    beginSegment(nextPath);
+    return true;
+}
+
+void DataLogger::finishSegment(bool closed)
+{
+    m_session.segments.last().complete = closed;
+    saveSegment();
+}
+
+void DataLogger::saveSegment()
+{
+    LogSegment &segment = m_session.segments.last();
+    segment.channels.clear();
+    for (quint8 type : std::as_const(m_segmentChannelOrder)) {
+        segment.channels.append(m_segmentChannels[type]);
+    }
+    segment.bytes = QFileInfo(m_segmentPath).size();
+
+    QString error;
+    if (!m_session.save(LogSession::manifestPath(m_firstSegmentPath), &error)) {
+        qWarning() << "Could not write session manifest:" << error;
+    }
+}
@@ -2,10 +2,47 @@
 #define DATALOGGER_H
 
 #include <QObject>
-#include <QFile>
-#include <QTextStream>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include <array>
+#include <memory>
+#include "csvlogwriter.h"
+#include "logsession.h"
+#include "logwriter.h"
 #include "sensordata.h"
 
+// Milloin lokiin kirjoitettu data siirretään käyttöjärjestelmälle ja levylle.
+// Ohjelman kaatuessa menetetään enintään flushIntervalMs verran dataa,
+// sähkökatkossa enintään syncIntervalMs (tai käyttöjärjestelmän oma viive).
+struct LogFlushPolicy {
+    int flushIntervalMs = 1000; // 0 = jokainen vastaanotettu erä heti
+    int flushSamples = 0;       // Kirjoitetaan myös, kun näin monta näytettä on odottamassa (0 = ei rajaa)
+    int syncIntervalMs = 0;     // fsync tämän välein (0 = ei koskaan)
+    int maxBufferedSamples = 1 << 20; // Tätä enemmän odottavia näytteitä pudotetaan
+};
+
+// Milloin lokitus jatkuu uuteen tiedostoon (osaan). Kaatuminen voi vioittaa
+// vain viimeisen osan lopun, ja katselija voi avata vain tarvitsemansa osat.
+struct LogRotationPolicy {
+    qint64 maxSegmentBytes = 256LL * 1024 * 1024; // 0 = ei kokorajaa
+    qint64 maxSegmentDurationMs = 60LL * 60 * 1000; // Näytteiden aikaleimojen mukaan, 0 = ei aikarajaa
+};
+
+/**
+ * @class DataLogger
+ * @brief Kirjoittaa näytteet lokitiedostoon taustasäikeessä.
+ *
+ * logSamples() vain lisää näytteet etupuskuriin lukon alla, joten sitä voi
+ * kutsua suoraan vastaanottajan säikeestä. Kirjoitussäie vaihtaa etu- ja
+ * takapuskurin paikkaa, muotoilee takapuskurin ilman lukkoa ja kirjoittaa
+ * sen LogFlushPolicy-asetusten mukaan.
+ *
+ * Loki jaetaan osiin LogRotationPolicy-asetusten mukaan, ja osat kuvataan
+ * istunnon manifestissa (ks. LogSession).
+ */
 class DataLogger : public QObject
 {
     Q_OBJECT
@@ -15,19 +52,81 @@ public:
 
     bool isLogging() const;
 
+    /**
+     * @brief Asettaa kirjoituskäytännön. Tulee voimaan seuraavasta startLogging()-kutsusta.
+     */
+    void setFlushPolicy(const LogFlushPolicy &policy);
+    LogFlushPolicy flushPolicy() const;
+
+    /**
+     * @brief Asettaa osiin jaon rajat. Tulee voimaan seuraavasta startLogging()-kutsusta.
+     */
+    void setRotationPolicy(const LogRotationPolicy &policy);
+    LogRotationPolicy rotationPolicy() const;
+
+    /**
+     * @brief Asettaa CSV-lokin rivimuodon. Tulee voimaan seuraavasta startLogging()-kutsusta.
+     */
+    void setCsvLayout(CsvLogWriter::Layout layout);
+    CsvLogWriter::Layout csvLayout() const;
+
+    /**
+     * @brief Puskurin ylivuodon takia pudotetut ja lokiformaatin ohittamat näytteet nykyisessä lokissa.
+     */
+    quint64 droppedSamples() const;
+
 public slots:
     bool startLogging(const QString &filePath);
     void stopLogging();
-    void logData(const SensorData &data);
+    void logData(const SensorSample &sample);
+    void logSamples(const QList<SensorSample> &samples);
 
 signals:
     void loggingStatusChanged(bool isActive, const QString &filePath);
     void errorOccurred(const QString &error);
 
 private:
-    QFile m_logFile;
-    QTextStream m_logStream;
+    // Keskeneräisen osan yhteenveto kirjoitetaan manifestiin enintään näin
+    // usein; jokainen tallennus korvaa koko manifestin
+    static constexpr int ManifestIntervalMs = 5000;
+
+    static std::unique_ptr<LogWriter> createWriter(const QString &filePath, CsvLogWriter::Layout csvLayout);
+
+    void writerLoop();
+    bool batchReady() const; // Kutsuttava m_mutex lukittuna
+    void beginSegment(const QString &filePath);
+    void summarize(const QVector<SensorSample> &samples);
+    bool rotationDue() const;
+    bool rotateSegment(QString *error);
+    void finishSegment(bool closed); // closed: kirjoittaja suljettiin virheittä
+    void saveSegment();
+
+    std::unique_ptr<LogWriter> m_writer;
+    QThread *m_writerThread = nullptr;
     bool m_isLogging = false;
+    LogFlushPolicy m_nextPolicy;
+    LogRotationPolicy m_nextRotation;
+    CsvLogWriter::Layout m_nextCsvLayout = CsvLogWriter::Layout::Long;
+
+    // Istunto; kirjoitussäikeen käytössä lokituksen ajan
+    LogRotationPolicy m_rotation;
+    CsvLogWriter::Layout m_csvLayout = CsvLogWriter::Layout::Long;
+    LogSession m_session;
+    QString m_firstSegmentPath;
+    QString m_segmentPath;
+    std::array<LogChannelSummary, 256> m_segmentChannels;
+    QList<quint8> m_segmentChannelOrder;
+
+    // Suojattu m_mutexilla
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    QVector<SensorSample> m_front; // Vastaanottaja täyttää
+    LogFlushPolicy m_policy;
+    bool m_accepting = false;
+    bool m_stopRequested = false;
+    quint64 m_droppedSamples = 0;
+
+    QVector<SensorSample> m_back;  // Vain kirjoitussäikeen käytössä
 };
 
-#endif // DATALOGGER_H 
\ No newline at end of file
+#endif // DATALOGGER_H
@@ -1,13 +1,25 @@
 #include "datareceiver.h"
 
 #include <QDebug>
-#include <QDataStream>
+#include <QDateTime>
+#include <QtEndian>
+#include <utility>
 
 DataReceiver::DataReceiver(QObject *parent)
-    : QObject(parent), m_serialPort(new QSerialPort(this)), m_buffer()
+    : QObject(parent), m_serialPort(new QSerialPort(this)), m_negotiationTimer(new QTimer(this))
 {
     connect(m_serialPort, &QSerialPort::readyRead, this, &DataReceiver::handleReadyRead);
     connect(m_serialPort, &QSerialPort::errorOccurred, this, &DataReceiver::handleError);
+
+    m_negotiationTimer->setSingleShot(true);
+    m_negotiationTimer->setInterval(NEGOTIATION_TIMEOUT_MS);
+    connect(m_negotiationTimer, &QTimer::timeout, this, &DataReceiver::handleNegotiationTimeout);
+
+    qRegisterMetaType<SensorSample>();
+    qRegisterMetaType<QList<SensorSample>>();
+    qRegisterMetaType<DeviceStatus>();
+
+    m_derived.setDefinitions(DerivedChannelEngine::defaultDefinitions());
 }
 
 DataReceiver::~DataReceiver()
@@ -24,8 +36,18 @@ bool DataReceiver::connectToPort(const QString &portName, qint32 baudRate)
     m_serialPort->setStopBits(QSerialPort::OneStop);
     m_serialPort->setFlowControl(QSerialPort::NoFlowControl);
 
-    if (m_serialPort->open(QIODevice::ReadOnly)) {
+    m_parser.reset();
+    m_reportedSkipped = 0;
+    m_clockSynced = false;
+    m_sequenceValid = false;
+    m_lostCycles = 0;
+    m_derived.reset();
+
+    // Kirjoitusoikeus tarvitaan protokollaversion neuvotteluun
+    if (m_serialPort->open(QIODevice::ReadWrite)) {
         qDebug() << "Yhdistetty porttiin" << portName;
+        m_lastFrameMs = QDateTime::currentMSecsSinceEpoch();
+        startNegotiation();
         emit portConnected();
         return true;
     } else {
@@ -37,6 +59,8 @@ bool DataReceiver::connectToPort(const QString &portName, qint32 baudRate)
 
 void DataReceiver::disconnectFromPort()
 {
+    m_negotiationTimer->stop();
+    m_negotiating = false;
     if (m_serialPort->isOpen()) {
         m_serialPort->close();
         qDebug() << "Portti suljettu.";
@@ -44,159 +68,222 @@ void DataReceiver::disconnectFromPort()
     }
 }
 
+quint64 DataReceiver::skippedBytes() const
+{
+    return m_parser.skippedBytes();
+}
+
 void DataReceiver::handleReadyRead()
 {
-    m_buffer.append(m_serialPort->readAll());
-    processBuffer();
+    // Luetaan suoraan rengaspuskuriin ilman välikopioita. Jos puskuri täyttyy,
+    // jäsennetään välissä, jolloin tilaa vapautuu.
+    while (m_serialPort->bytesAvailable() > 0) {
+        const int space = m_parser.writableSize();
+        if (space > 0) {
+            const qint64 n = m_serialPort->read(m_parser.writePointer(), space);
+            if (n <= 0) {
+                break;
+            }
+            m_parser.commit(int(n));
+        }
+        processBuffer();
+    }
 }
 
 void DataReceiver::processBuffer()
 {
-    while (m_buffer.size() >= 4) { // Minimikoko paketille: start(1) + type(1) + len(1) + checksum(1) = 4
-        // 1. Etsi aloitusmerkki
-        int startIndex = m_buffer.indexOf(START_BYTE);
-        if (startIndex == -1) {
-            // Ei aloitusmerkkiä, tyhjennä puskuri
-            m_buffer.clear();
-            return;
-        }
+    // Kaikki samalla luvulla saapuneet näytteet saavat saman vastaanottoajan
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
 
-        // Siirrä puskurin alku aloitusmerkkiin
-        if (startIndex > 0) {
-            qDebug() << "Ohitetaan" << startIndex << "tavua roskaa puskurin alusta.";
-            m_buffer = m_buffer.mid(startIndex);
+    FrameParser::Frame frame;
+    SensorSample sample;
+    while (m_parser.next(frame)) {
+        m_lastFrameMs = now;
+        if (frame.type == BATCH_FRAME) {
+            parseBatch(frame, now);
+        } else if (frame.type == STATUS_FRAME) {
+            parseStatus(frame);
+        } else if (frame.type == PROTOCOL_FRAME) {
+            parseProtocol(frame);
+        } else if (parsePayload(frame.type, frame.payload, frame.length, sample)) {
+            sample.timestampMs = now;
+            m_batch.append(sample);
         }
+    }
 
-        // Tarvitaanko lisää dataa headerille?
-        if (m_buffer.size() < 3) { // start(1) + type(1) + len(1)
-            return; // Odota lisää dataa
-        }
+    // Koko luettu erä toimitetaan kerralla yhden signaalin sijaan näytettä kohden
+    if (!m_batch.isEmpty()) {
+        m_derived.process(m_batch);
+        emit samplesReceived(std::exchange(m_batch, {}));
+    }
 
-        // 2. Lue header (tyyppi ja pituus)
-        quint8 sensorType_raw = m_buffer.at(1);
-        quint8 dataLen = m_buffer.at(2);
+    if (m_parser.skippedBytes() != m_reportedSkipped) {
+        qDebug() << "Ohitettiin" << m_parser.skippedBytes() - m_reportedSkipped
+                 << "tavua roskaa, virheellisiä tarkistussummia yhteensä" << m_parser.checksumErrors();
+        m_reportedSkipped = m_parser.skippedBytes();
+    }
 
-        // 3. Tarkista onko koko paketti saapunut
-        int packetSize = 1 + 1 + 1 + dataLen + 1; // start + type + len + payload + checksum
-        if (m_buffer.size() < packetSize) {
-            return; // Odota lisää dataa
-        }
+    // Laite on todennäköisesti käynnistynyt uudelleen ja palannut versioon 1
+    if (!m_negotiating && m_parser.protocol() == FrameParser::Protocol::V2
+        && now - m_lastFrameMs > RENEGOTIATE_AFTER_MS) {
+        qDebug() << "Kelvollisia kehyksiä ei ole tullut, neuvotellaan protokolla uudelleen";
+        m_lastFrameMs = now;
+        startNegotiation();
+    }
+}
 
-        // Nyt meillä on koko paketti puskurissa
-        QByteArray packet = m_buffer.left(packetSize);
-        m_buffer.remove(0, packetSize);
+bool DataReceiver::parsePayload(quint8 typeId, const quint8 *payload, int size, SensorSample &sample)
+{
+    const SensorInfo *info = findSensor(typeId);
+    if (!info) {
+        qDebug() << "Tuntematon anturityyppi" << Qt::hex << typeId;
+        return false;
+    }
+    if (size != wireSize(info->format)) {
+        qDebug() << "Väärä datan pituus anturille" << info->name << ":" << size;
+        return false;
+    }
 
-        // 4. Lue payload ja tarkistussumma
-        QByteArray payload = packet.mid(3, dataLen);
-        quint8 receivedChecksum = static_cast<quint8>(packet.at(packetSize - 1));
+    sample.type = info->type;
+    sample.value = decodeSensorValue(*info, payload);
+    return true;
+}
 
-        // 5. Varmenna tarkistussumma
-        quint8 calculatedChecksum = 0;
-        // XOR-lasku start-tavusta payloadin loppuun
-        for (int i = 0; i < packetSize - 1; ++i) {
-            calculatedChecksum ^= static_cast<quint8>(packet.at(i));
-        }
+void DataReceiver::parseBatch(const FrameParser::Frame &frame, qint64 receivedMs)
+{
+    if (frame.length < BATCH_HEADER_SIZE) {
+        qDebug() << "Liian lyhyt eräkehys:" << frame.length;
+        return;
+    }
+
+    const quint16 sequence = qFromLittleEndian<quint16>(frame.payload);
+    const quint32 deviceMs = qFromLittleEndian<quint32>(frame.payload + 2);
+    trackSequence(sequence);
+    const qint64 timestampMs = deviceToHostTime(deviceMs, receivedMs);
 
-        if (calculatedChecksum == receivedChecksum) {
-            SensorType type = static_cast<SensorType>(sensorType_raw);
-            SensorData parsed = parsePayload(type, payload);
-            qDebug() << "Vastaanotettu data: Anturi=" << parsed.name << "Arvo=" << parsed.value.toString() << parsed.unit;
-            emit newDataReceived(parsed);
-        } else {
-            qDebug() << "Virheellinen tarkistussumma! Vastaanotettu:" << receivedChecksum << "Laskettu:" << calculatedChecksum;
+    // Loput datasta on peräkkäisiä (tyyppi, arvo) -pareja. Arvon pituus
+    // tulee anturirekisteristä, joten tuntemattoman tyypin jälkeen kehystä
+    // ei voi jatkaa.
+    int pos = BATCH_HEADER_SIZE;
+    while (pos < frame.length) {
+        const SensorInfo *info = findSensor(frame.payload[pos]);
+        if (!info) {
+            qDebug() << "Tuntematon anturityyppi eräkehyksessä" << Qt::hex << frame.payload[pos];
+            return;
+        }
+        const int width = wireSize(info->format);
+        if (pos + 1 + width > frame.length) {
+            qDebug() << "Katkennut arvo eräkehyksessä anturille" << info->name;
+            return;
         }
+
+        SensorSample sample;
+        sample.timestampMs = timestampMs;
+        sample.value = decodeSensorValue(*info, frame.payload + pos + 1);
+        sample.type = info->type;
+        m_batch.append(sample);
+        pos += 1 + width;
     }
 }
 
-SensorData DataReceiver::parsePayload(SensorType type, const QByteArray &payload)
+void DataReceiver::parseStatus(const FrameParser::Frame &frame)
 {
-    SensorData data;
-    data.type = type;
+    if (frame.length < STATUS_SIZE) {
+        qDebug() << "Liian lyhyt tilakehys:" << frame.length;
+        return;
+    }
 
-    switch (type) {
-    case SensorType::OIL_TEMPERATURE: {
-        if (payload.size() == 4) {
-            float value;
-            QDataStream stream(payload);
-            stream.setByteOrder(QDataStream::LittleEndian);
-            stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
-            stream >> value;
-            data.name = "Öljylämpötila";
-            data.value = QVariant(QString::number(value, 'f', 1));
-            data.unit = " °C";
-        }
-        break;
-    }
-    case SensorType::PRIMARY_AXLE_RPM: {
-        if (payload.size() == 2) {
-            quint16 rpm;
-            QDataStream stream(payload);
-            stream.setByteOrder(QDataStream::LittleEndian);
-            stream >> rpm;
-            data.name = "Ensiöakseli";
-            data.value = QVariant(QString::number(rpm, 'f', 1));
-            data.unit = " rpm";
-        }
-        break;
-    }
-    case SensorType::SECONDARY_AXLE_RPM: {
-        if (payload.size() == 2) {
-            quint16 rpm;
-            QDataStream stream(payload);
-            stream.setByteOrder(QDataStream::LittleEndian);
-            stream >> rpm;
-            data.name = "Toisioakseli";
-            data.value = QVariant(QString::number(rpm, 'f', 1));
-            data.unit = " rpm";
-        }
-        break;
-    }
-    case SensorType::GEARBOX_TORQUE: {
-        if (payload.size() == 4) {
-            float value;
-            QDataStream stream(payload);
-            stream.setByteOrder(QDataStream::LittleEndian);
-            stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
-            stream >> value;
-            data.name = "Vaihteiston vääntö";
-            data.value = QVariant(QString::number(value, 'f', 1));
-            data.unit = " Nm";
-        }
-        break;
-    }
-    case SensorType::BRAKE_TORQUE: {
-        if (payload.size() == 4) {
-            float value;
-            QDataStream stream(payload);
-            stream.setByteOrder(QDataStream::LittleEndian);
-            stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
-            stream >> value;
-            data.name = "Jarrun vääntö";
-            data.value = QVariant(QString::number(value, 'f', 1));
-            data.unit = " Nm";
-        }
-        break;
-    }
-    case SensorType::AIR_TEMPERATURE: {
-        if (payload.size() == 4) {
-            float value;
-            QDataStream stream(payload);
-            stream.setByteOrder(QDataStream::LittleEndian);
-            stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
-            stream >> value;
-            data.name = "Ilman lämpötila";
-            data.value = QVariant(QString::number(value, 'f', 1));
-            data.unit = " °C";
+    DeviceStatus status;
+    status.droppedFrames = qFromLittleEndian<quint32>(frame.payload);
+    status.overruns = qFromLittleEndian<quint32>(frame.payload + 4);
+    status.maxLatenessUs = qFromLittleEndian<quint32>(frame.payload + 8);
+    status.meanLatenessUs = qFromLittleEndian<quint32>(frame.payload + 12);
+    status.lostCycles = m_lostCycles;
+    emit deviceStatusReceived(status);
+}
+
+void DataReceiver::parseProtocol(const FrameParser::Frame &frame)
+{
+    if (frame.length < 1) {
+        qDebug() << "Liian lyhyt protokollakehys";
+        return;
+    }
+
+    // Laite kuittaa versiolla, jonka se otti käyttöön; kuittaus on jo koodattu sillä
+    m_negotiationTimer->stop();
+    m_negotiating = false;
+    const auto protocol = frame.payload[0] == quint8(FrameParser::Protocol::V2)
+        ? FrameParser::Protocol::V2 : FrameParser::Protocol::V1;
+    m_parser.setProtocol(protocol);
+    qDebug() << "Laite käyttää protokollaversiota" << frame.payload[0];
+}
+
+void DataReceiver::startNegotiation()
+{
+    // Jäsennin siirtyy heti versioon 2. Ennen kuittausta saapuvat versio 1
+    // -kehykset hylätään, mikä koskee vain yhteyden ensimmäisiä millisekunteja.
+    m_negotiating = true;
+    m_negotiationAttempts = 0;
+    m_parser.setProtocol(FrameParser::Protocol::V2);
+    sendProtocolCommand(FrameParser::Protocol::V2);
+    m_negotiationTimer->start();
+}
+
+void DataReceiver::sendProtocolCommand(FrameParser::Protocol protocol)
+{
+    // Komennot lähetetään aina versio 1 -kehyksinä
+    char command[5];
+    command[0] = char(0xAA);
+    command[1] = char(PROTOCOL_FRAME);
+    command[2] = 1;
+    command[3] = char(protocol);
+    command[4] = char(command[0] ^ command[1] ^ command[2] ^ command[3]);
+    m_serialPort->write(command, sizeof(command));
+}
+
+void DataReceiver::handleNegotiationTimeout()
+{
+    if (!m_negotiating || !m_serialPort->isOpen()) {
+        return;
+    }
+    if (++m_negotiationAttempts < NEGOTIATION_ATTEMPTS) {
+        sendProtocolCommand(FrameParser::Protocol::V2);
+        m_negotiationTimer->start();
+        return;
+    }
+
+    // Vanha laiteohjelmisto ei tunne komentoa
+    m_negotiating = false;
+    m_parser.setProtocol(FrameParser::Protocol::V1);
+    qDebug() << "Laite ei kuitannut protokollaversiota 2, käytetään versiota 1";
+}
+
+void DataReceiver::trackSequence(quint16 sequence)
+{
+    // Yksi mittauskierros voi jakautua useaan kehykseen samalla numerolla
+    if (m_sequenceValid && sequence != m_lastSequence) {
+        const quint16 gap = quint16(sequence - m_lastSequence - 1);
+        if (gap > 0 && gap < 0x8000) {
+            m_lostCycles += gap;
+            qDebug() << "Kadotettiin" << gap << "mittauskierrosta, yhteensä" << m_lostCycles;
         }
-        break;
     }
-    default:
-        data.name = "Tuntematon";
-        data.value = QVariant(payload.toHex());
-        data.unit = "";
-        break;
+    m_lastSequence = sequence;
+    m_sequenceValid = true;
+}
+
+qint64 DataReceiver::deviceToHostTime(quint32 deviceMs, qint64 receivedMs)
+{
+    // Laitteen kello sidotaan isäntäkoneen kelloon ensimmäisestä kehyksestä.
+    // Jos ero kasvaa liian suureksi (laite käynnistyi uudelleen tai kello
+    // ajautui), sidotaan uudelleen.
+    const qint64 estimate = m_clockOffsetMs + deviceMs;
+    if (!m_clockSynced || qAbs(receivedMs - estimate) > CLOCK_RESYNC_MS) {
+        m_clockOffsetMs = receivedMs - deviceMs;
+        m_clockSynced = true;
+        return receivedMs;
     }
-    return data;
+    return estimate;
 }
 
 void DataReceiver::handleError(QSerialPort::SerialPortError error)
@@ -2,9 +2,40 @@
 #define DATARECEIVER_H
 
 #include <QObject>
+#include <QList>
 #include <QSerialPort>
+#include <QTimer>
 #include "sensordata.h"
+#include "frameparser.h"
+#include "derivedchannelengine.h"
 
+// Laitteen tilakehyksen sisältö
+struct DeviceStatus {
+    quint32 droppedFrames;   // Laitteen lähetysjonosta pudotetut kehykset edellisen tilakehyksen jälkeen
+    quint32 overruns;        // Laitteen ajastimen väliin jääneet jaksot
+    quint32 maxLatenessUs;   // Suurin myöhästyminen määräajasta
+    quint32 meanLatenessUs;  // Keskimääräinen myöhästyminen määräajasta
+    quint64 lostCycles;      // Isäntäkoneen havaitsemat puuttuvat mittauskierrokset yhteensä
+};
+
+Q_DECLARE_METATYPE(DeviceStatus)
+
+/**
+ * @class DataReceiver
+ * @brief Lukee ja jäsentää sarjaportin datan.
+ *
+ * Olio on tarkoitettu ajettavaksi omassa säikeessään (moveToThread), jolloin
+ * käyttöliittymän piirto tai modaaliset dialogit eivät pysäytä lukemista.
+ * Slotteja kutsutaan muista säikeistä jonotettuina, ja jäsennetyt näytteet
+ * toimitetaan eränä yhdellä signaalilla jokaista readyRead-tapahtumaa kohden.
+ *
+ * Yhdistettäessä laitteelta pyydetään protokollaversiota 2 (COBS ja CRC-16).
+ * Jos laite ei kuittaa pyyntöä, palataan versioon 1, jotta vanhemmat
+ * laiteohjelmistot toimivat edelleen.
+ *
+ * Laskennalliset kanavat (DerivedChannelEngine) lisätään erään ennen sen
+ * lähettämistä, joten vastaanottajat näkevät ne kuten mitatut kanavat.
+ */
 class DataReceiver : public QObject
 {
     Q_OBJECT
@@ -12,11 +43,18 @@ public:
     explicit DataReceiver(QObject *parent = nullptr);
     ~DataReceiver();
 
+    /**
+     * @brief Ohitettujen tavujen määrä. Kutsuttava vastaanottajan omasta säikeestä.
+     */
+    quint64 skippedBytes() const;
+
+public slots:
     bool connectToPort(const QString &portName, qint32 baudRate);
     void disconnectFromPort();
 
 signals:
-    void newDataReceived(const SensorData &data);
+    void samplesReceived(const QList<SensorSample> &samples);
+    void deviceStatusReceived(const DeviceStatus &status);
     void errorOccurred(const QString &errorString);
     void portConnected();
     void portDisconnected();
@@ -24,15 +62,48 @@ signals:
 private slots:
     void handleReadyRead();
     void handleError(QSerialPort::SerialPortError error);
+    void handleNegotiationTimeout();
 
 private:
     void processBuffer();
-    SensorData parsePayload(SensorType type, const QByteArray &payload);
+    bool parsePayload(quint8 typeId, const quint8 *payload, int size, SensorSample &sample);
+    void parseBatch(const FrameParser::Frame &frame, qint64 receivedMs);
+    void parseStatus(const FrameParser::Frame &frame);
+    void parseProtocol(const FrameParser::Frame &frame);
+    void startNegotiation();
+    void sendProtocolCommand(FrameParser::Protocol protocol);
+    void trackSequence(quint16 sequence);
+    qint64 deviceToHostTime(quint32 deviceMs, qint64 receivedMs);
+
+    // Tyypit 0x01-0x0F on varattu ohjauskehyksille, anturityypit alkavat 0x10:stä.
+    // Eräkehys: sekvenssinumero (u16), laitteen aika ms (u32) ja perään
+    // (tyyppi, arvo) -parit kaikista saman kierroksen antureista.
+    static constexpr quint8 BATCH_FRAME = 0x01;
+    static constexpr quint8 STATUS_FRAME = 0x02;
+    static constexpr quint8 PROTOCOL_FRAME = 0x03; // Komento ja kuittaus: 1 tavu, protokollaversio
+    static constexpr int BATCH_HEADER_SIZE = 6;
+    static constexpr int STATUS_SIZE = 16;
+    static constexpr qint64 CLOCK_RESYNC_MS = 1000;
+    static constexpr int NEGOTIATION_TIMEOUT_MS = 300;
+    static constexpr int NEGOTIATION_ATTEMPTS = 3;
+    static constexpr qint64 RENEGOTIATE_AFTER_MS = 1000; // Dataa tulee, mutta yksikään kehys ei kelpaa
 
     QSerialPort *m_serialPort;
-    QByteArray m_buffer;
+    FrameParser m_parser;
+    QList<SensorSample> m_batch;
+    DerivedChannelEngine m_derived;
+    quint64 m_reportedSkipped = 0;
+
+    QTimer *m_negotiationTimer;
+    bool m_negotiating = false;
+    int m_negotiationAttempts = 0;
+    qint64 m_lastFrameMs = 0;
 
-    const quint8 START_BYTE = 0xAA;
+    bool m_clockSynced = false;
+    qint64 m_clockOffsetMs = 0;
+    bool m_sequenceValid = false;
+    quint16 m_lastSequence = 0;
+    quint64 m_lostCycles = 0;
 };
 
 #endif // DATARECEIVER_H
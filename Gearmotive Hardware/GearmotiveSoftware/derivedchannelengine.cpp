@@ -0,0 +1,186 @@
+#include "derivedchannelengine.h"
+
+#include <QObject>
+#include <QVarLengthArray>
+#include <algorithm>
+#include <cmath>
+
+QList<DerivedChannelDefinition> DerivedChannelEngine::defaultDefinitions()
+{
+    // Teho kW = vääntö (Nm) * kierrosnopeus (rpm) * 2 pi / 60 / 1000
+    return {
+        { SensorType::GEAR_RATIO,   QStringLiteral("PRIMARY_AXLE_RPM / SECONDARY_AXLE_RPM") },
+        { SensorType::INPUT_POWER,  QStringLiteral("GEARBOX_TORQUE * PRIMARY_AXLE_RPM * 2 * pi / 60000") },
+        { SensorType::OUTPUT_POWER, QStringLiteral("BRAKE_TORQUE * SECONDARY_AXLE_RPM * 2 * pi / 60000") },
+        { SensorType::EFFICIENCY,   QStringLiteral("100 * OUTPUT_POWER / INPUT_POWER") },
+    };
+}
+
+bool DerivedChannelEngine::setDefinitions(const QList<DerivedChannelDefinition> &definitions, QString *error)
+{
+    QList<Channel> channels;
+    for (const DerivedChannelDefinition &definition : definitions) {
+        const QString &name = sensorInfo(definition.type).name;
+        Channel channel { definition.type, DerivedExpression() };
+        QString message;
+        if (!channel.expression.compile(definition.expression, &message)) {
+            if (error) {
+                *error = QStringLiteral("%1: %2").arg(name, message);
+            }
+            return false;
+        }
+
+        // Laskentajärjestys on määrittelyjärjestys, joten viittaukset
+        // laskennallisiin kanaviin saavat osoittaa vain taaksepäin
+        for (SensorType input : channel.expression.inputs()) {
+            const bool derived = input == definition.type
+                || std::any_of(definitions.cbegin(), definitions.cend(),
+                               [input](const DerivedChannelDefinition &d) { return d.type == input; });
+            const bool earlier = std::any_of(channels.cbegin(), channels.cend(),
+                                             [input](const Channel &c) { return c.type == input; });
+            if (derived && !earlier) {
+                if (error) {
+                    *error = QObject::tr("%1: kanava %2 on määriteltävä ennen tätä kanavaa.")
+                                 .arg(name, sensorInfo(input).name);
+                }
+                return false;
+            }
+        }
+        channels.append(std::move(channel));
+    }
+
+    m_channels = std::move(channels);
+    reset();
+    return true;
+}
+
+const DerivedChannelEngine::Channel *DerivedChannelEngine::find(SensorType type) const
+{
+    for (const Channel &channel : m_channels) {
+        if (channel.type == type) {
+            return &channel;
+        }
+    }
+    return nullptr;
+}
+
+void DerivedChannelEngine::reset()
+{
+    m_latest.fill(Latest());
+    m_generation = 0;
+}
+
+void DerivedChannelEngine::process(QList<SensorSample> &samples)
+{
+    if (m_channels.isEmpty() || samples.isEmpty()) {
+        return;
+    }
+
+    QList<SensorSample> output;
+    output.reserve(samples.size() + m_channels.size());
+    QVarLengthArray<double, 8> values;
+
+    qsizetype i = 0;
+    while (i < samples.size()) {
+        // Yksi mittauskierros: päivitetään syötteet ja merkitään ne tämän kierroksen arvoiksi
+        const qint64 timestampMs = samples[i].timestampMs;
+        ++m_generation;
+        for (; i < samples.size() && samples[i].timestampMs == timestampMs; ++i) {
+            const SensorSample &sample = samples[i];
+            output.append(sample);
+            m_latest[quint8(sample.type)] = { timestampMs, sample.value, m_generation, true };
+        }
+
+        for (const Channel &channel : std::as_const(m_channels)) {
+            bool changed = false;
+            bool available = true;
+            values.clear();
+            for (SensorType input : channel.expression.inputs()) {
+                const Latest &latest = m_latest[quint8(input)];
+                if (!latest.valid || timestampMs - latest.timestampMs > MaxInputAgeMs) {
+                    available = false;
+                    break;
+                }
+                changed |= latest.generation == m_generation;
+                values.append(latest.value);
+            }
+            if (!available || !changed) {
+                continue;
+            }
+
+            // Esim. nollanopeudella jakaminen ei tuota näytettä
+            Latest &own = m_latest[quint8(channel.type)];
+            const double value = channel.expression.evaluate(values.constData());
+            if (!std::isfinite(value)) {
+                own.valid = false;
+                continue;
+            }
+            own = { timestampMs, value, m_generation, true };
+            output.append({ timestampMs, value, channel.type });
+        }
+    }
+
+    samples = std::move(output);
+}
+
+ChannelData DerivedChannelEngine::evaluate(const DerivedExpression &expression, const QList<const ChannelData *> &inputs)
+{
+    ChannelData result;
+    if (!expression.isValid() || inputs.size() != expression.inputs().size()) {
+        return result;
+    }
+
+    // Aikajana on syötteiden aikaleimojen yhdiste; syötteet ovat valmiiksi järjestyksessä
+    QVector<qint64> timeline;
+    for (const ChannelData *input : inputs) {
+        if (input->isEmpty()) {
+            return result;
+        }
+        const qsizetype middle = timeline.size();
+        timeline.append(input->timestamps());
+        std::inplace_merge(timeline.begin(), timeline.begin() + middle, timeline.end());
+    }
+    timeline.erase(std::unique(timeline.begin(), timeline.end()), timeline.end());
+    const qsizetype size = timeline.size();
+
+    // Jokainen syöte aikajanalle edellisen arvon pidolla
+    QVector<char> valid(size, 1);
+    QList<QVector<double>> columns;
+    columns.reserve(inputs.size());
+    for (const ChannelData *input : inputs) {
+        const qint64 *timestamps = input->timestamps().constData();
+        const double *source = input->values().constData();
+        const qsizetype count = input->size();
+
+        QVector<double> column(size);
+        double *out = column.data();
+        qsizetype j = -1;
+        for (qsizetype row = 0; row < size; ++row) {
+            while (j + 1 < count && timestamps[j + 1] <= timeline[row]) {
+                ++j;
+            }
+            if (j < 0 || timeline[row] - timestamps[j] > MaxInputAgeMs) {
+                valid[row] = 0;
+                out[row] = 0.0;
+            } else {
+                out[row] = source[j];
+            }
+        }
+        columns.append(std::move(column));
+    }
+
+    const QVector<double> values = expression.evaluate(columns, size);
+
+    QVector<qint64> resultTimestamps;
+    QVector<double> resultValues;
+    resultTimestamps.reserve(size);
+    resultValues.reserve(size);
+    for (qsizetype row = 0; row < size; ++row) {
+        if (valid[row] && std::isfinite(values[row])) {
+            resultTimestamps.append(timeline[row]);
+            resultValues.append(values[row]);
+        }
+    }
+    result.assign(std::move(resultTimestamps), std::move(resultValues));
+    return result;
+}
@@ -0,0 +1,88 @@
+#ifndef DERIVEDCHANNELENGINE_H
+#define DERIVEDCHANNELENGINE_H
+
+#include <QList>
+#include <QString>
+#include <array>
+#include "channeldata.h"
+#include "derivedexpression.h"
+#include "sensordata.h"
+
+// Laskennallisen kanavan määrittely: tulostyyppi ja sen lauseke
+struct DerivedChannelDefinition {
+    SensorType type;
+    QString expression;
+};
+
+/**
+ * @class DerivedChannelEngine
+ * @brief Laskee laskennalliset kanavat mitatuista kanavista.
+ *
+ * Reaaliaikaisessa datassa process() lisää laskennalliset näytteet suoraan
+ * vastaanotettuun erään, joten loggeri, kaavio ja arvonäytöt käsittelevät niitä
+ * kuten mitattuja kanavia. Kanava lasketaan uudelleen vain, kun jokin sen
+ * syötteistä päivittyi; muiden syötteiden viimeisin arvo pidetään voimassa
+ * enintään MaxInputAgeMs.
+ *
+ * Lokeille evaluate() laskee koko kanavan kerralla: syötteet kohdistetaan
+ * yhteiselle aikajanalle ja lauseke lasketaan sarakkeittain.
+ */
+class DerivedChannelEngine
+{
+public:
+    struct Channel {
+        SensorType type;
+        DerivedExpression expression;
+    };
+
+    // Syötteen viimeisin arvo kelpaa laskentaan enintään näin kauan
+    static constexpr qint64 MaxInputAgeMs = 1000;
+
+    /**
+     * @brief Vakiokanavat: välityssuhde, tulo- ja lähtöteho sekä hyötysuhde.
+     */
+    static QList<DerivedChannelDefinition> defaultDefinitions();
+
+    /**
+     * @brief Kääntää määrittelyt. Kanava voi käyttää vain aiemmin määriteltyjä laskennallisia kanavia.
+     * @return false ja virheilmoitus, jos jokin lauseke on virheellinen; vanhat määrittelyt säilyvät.
+     */
+    bool setDefinitions(const QList<DerivedChannelDefinition> &definitions, QString *error = nullptr);
+
+    const QList<Channel> &channels() const { return m_channels; }
+    const Channel *find(SensorType type) const;
+
+    /**
+     * @brief Unohtaa syötteiden viimeisimmät arvot, esim. uuden yhteyden alussa.
+     */
+    void reset();
+
+    /**
+     * @brief Lisää erään laskennalliset näytteet kunkin mittauskierroksen näytteiden perään.
+     *
+     * Mittauskierros on joukko peräkkäisiä näytteitä, joilla on sama aikaleima.
+     */
+    void process(QList<SensorSample> &samples);
+
+    /**
+     * @brief Laskee kanavan lokin kanavista. @p inputs on lausekkeen inputs():n järjestyksessä.
+     *
+     * Aikajana on syötteiden aikaleimojen yhdiste. Rivit, joilla jokin syöte
+     * puuttuu tai on vanhentunut tai tulos ei ole äärellinen, jätetään pois.
+     */
+    static ChannelData evaluate(const DerivedExpression &expression, const QList<const ChannelData *> &inputs);
+
+private:
+    struct Latest {
+        qint64 timestampMs = 0;
+        double value = 0.0;
+        quint64 generation = 0;
+        bool valid = false;
+    };
+
+    QList<Channel> m_channels;
+    std::array<Latest, 256> m_latest {};
+    quint64 m_generation = 0;
+};
+
+#endif // DERIVEDCHANNELENGINE_H
@@ -0,0 +1,336 @@
+#include "derivedexpression.h"
+
+#include <QObject>
+#include <QVarLengthArray>
+#include <cmath>
+
+namespace {
+
+// Lausekkeissa käytettävät kanavien tunnisteet (SensorType-enumin nimet)
+struct Identifier {
+    const char *name;
+    SensorType type;
+};
+
+const Identifier IDENTIFIERS[] = {
+    { "OIL_TEMPERATURE",    SensorType::OIL_TEMPERATURE },
+    { "PRIMARY_AXLE_RPM",   SensorType::PRIMARY_AXLE_RPM },
+    { "SECONDARY_AXLE_RPM", SensorType::SECONDARY_AXLE_RPM },
+    { "GEARBOX_TORQUE",     SensorType::GEARBOX_TORQUE },
+    { "BRAKE_TORQUE",       SensorType::BRAKE_TORQUE },
+    { "AIR_TEMPERATURE",    SensorType::AIR_TEMPERATURE },
+    { "ACCELERATION_X",     SensorType::ACCELERATION_X },
+    { "ACCELERATION_Y",     SensorType::ACCELERATION_Y },
+    { "ACCELERATION_Z",     SensorType::ACCELERATION_Z },
+    { "SOUND_LEVEL",        SensorType::SOUND_LEVEL },
+    { "GEAR_RATIO",         SensorType::GEAR_RATIO },
+    { "INPUT_POWER",        SensorType::INPUT_POWER },
+    { "OUTPUT_POWER",       SensorType::OUTPUT_POWER },
+    { "EFFICIENCY",         SensorType::EFFICIENCY },
+};
+
+const double PI = 3.14159265358979323846;
+
+// Sarakelaskennan pinon alkio: joko vakio tai kokonainen sarake
+struct Operand {
+    QVector<double> column;
+    double scalar = 0.0;
+    bool isColumn = false;
+};
+
+// Yhdistää kaksi operandia; tulos jää vasempaan. Sarake kopioidaan vain,
+// jos kumpikaan operandi ei ole valmiiksi oma väliaikainen sarake.
+template <typename F>
+void combine(Operand &a, Operand &b, qsizetype size, F f)
+{
+    if (!a.isColumn && !b.isColumn) {
+        a.scalar = f(a.scalar, b.scalar);
+    } else if (!b.isColumn) {
+        double *out = a.column.data();
+        const double s = b.scalar;
+        for (qsizetype i = 0; i < size; ++i) {
+            out[i] = f(out[i], s);
+        }
+    } else if (!a.isColumn) {
+        const double s = a.scalar;
+        a.column = std::move(b.column);
+        a.isColumn = true;
+        double *out = a.column.data();
+        for (qsizetype i = 0; i < size; ++i) {
+            out[i] = f(s, out[i]);
+        }
+    } else {
+        double *out = a.column.data();
+        const double *in = b.column.constData();
+        for (qsizetype i = 0; i < size; ++i) {
+            out[i] = f(out[i], in[i]);
+        }
+    }
+}
+
+} // namespace
+
+bool DerivedExpression::compile(const QString &text, QString *error)
+{
+    m_program.clear();
+    m_inputs.clear();
+    m_depth = 0;
+    m_maxDepth = 0;
+
+    Parser parser;
+    parser.text = text;
+    bool ok = parseSum(parser);
+    while (ok && parser.pos < text.size() && text[parser.pos].isSpace()) {
+        ++parser.pos;
+    }
+    if (ok && parser.pos < text.size()) {
+        parser.error = QObject::tr("Odottamaton merkki '%1' kohdassa %2.").arg(text[parser.pos]).arg(parser.pos + 1);
+        ok = false;
+    }
+
+    if (!ok) {
+        m_program.clear();
+        m_inputs.clear();
+        if (error) {
+            *error = parser.error;
+        }
+    }
+    return ok;
+}
+
+void DerivedExpression::emitOp(Op op, int input, double constant)
+{
+    m_program.append({ op, input, constant });
+    if (op == Op::Input || op == Op::Constant) {
+        m_maxDepth = qMax(m_maxDepth, ++m_depth);
+    } else if (op != Op::Negate) {
+        --m_depth;
+    }
+}
+
+// summa := tulo (('+' | '-') tulo)*
+bool DerivedExpression::parseSum(Parser &parser)
+{
+    if (!parseProduct(parser)) {
+        return false;
+    }
+    for (;;) {
+        while (parser.pos < parser.text.size() && parser.text[parser.pos].isSpace()) {
+            ++parser.pos;
+        }
+        if (parser.pos >= parser.text.size()) {
+            return true;
+        }
+        const QChar c = parser.text[parser.pos];
+        if (c != u'+' && c != u'-') {
+            return true;
+        }
+        ++parser.pos;
+        if (!parseProduct(parser)) {
+            return false;
+        }
+        emitOp(c == u'+' ? Op::Add : Op::Subtract);
+    }
+}
+
+// tulo := unaari (('*' | '/') unaari)*
+bool DerivedExpression::parseProduct(Parser &parser)
+{
+    if (!parseUnary(parser)) {
+        return false;
+    }
+    for (;;) {
+        while (parser.pos < parser.text.size() && parser.text[parser.pos].isSpace()) {
+            ++parser.pos;
+        }
+        if (parser.pos >= parser.text.size()) {
+            return true;
+        }
+        const QChar c = parser.text[parser.pos];
+        if (c != u'*' && c != u'/') {
+            return true;
+        }
+        ++parser.pos;
+        if (!parseUnary(parser)) {
+            return false;
+        }
+        emitOp(c == u'*' ? Op::Multiply : Op::Divide);
+    }
+}
+
+// unaari := '-' unaari | perus
+bool DerivedExpression::parseUnary(Parser &parser)
+{
+    while (parser.pos < parser.text.size() && parser.text[parser.pos].isSpace()) {
+        ++parser.pos;
+    }
+    if (parser.pos < parser.text.size() && parser.text[parser.pos] == u'-') {
+        ++parser.pos;
+        if (!parseUnary(parser)) {
+            return false;
+        }
+        emitOp(Op::Negate);
+        return true;
+    }
+    return parsePrimary(parser);
+}
+
+// perus := luku | 'pi' | tunniste | '(' summa ')'
+bool DerivedExpression::parsePrimary(Parser &parser)
+{
+    const QString &text = parser.text;
+    if (parser.pos >= text.size()) {
+        parser.error = QObject::tr("Lauseke päättyy kesken.");
+        return false;
+    }
+
+    const int start = parser.pos;
+    const QChar c = text[start];
+    if (c == u'(') {
+        ++parser.pos;
+        if (!parseSum(parser)) {
+            return false;
+        }
+        while (parser.pos < text.size() && text[parser.pos].isSpace()) {
+            ++parser.pos;
+        }
+        if (parser.pos >= text.size() || text[parser.pos] != u')') {
+            parser.error = QObject::tr("Puuttuva ')' kohdassa %1.").arg(parser.pos + 1);
+            return false;
+        }
+        ++parser.pos;
+        return true;
+    }
+
+    if (c.isDigit() || c == u'.') {
+        while (parser.pos < text.size() && (text[parser.pos].isDigit() || text[parser.pos] == u'.')) {
+            ++parser.pos;
+        }
+        // Eksponentti, esim. 1e-3
+        if (parser.pos < text.size() && (text[parser.pos] == u'e' || text[parser.pos] == u'E')) {
+            int end = parser.pos + 1;
+            if (end < text.size() && (text[end] == u'+' || text[end] == u'-')) {
+                ++end;
+            }
+            if (end < text.size() && text[end].isDigit()) {
+                while (end < text.size() && text[end].isDigit()) {
+                    ++end;
+                }
+                parser.pos = end;
+            }
+        }
+        bool ok = false;
+        const double value = QStringView(text).mid(start, parser.pos - start).toDouble(&ok);
+        if (!ok) {
+            parser.error = QObject::tr("Virheellinen luku kohdassa %1.").arg(start + 1);
+            return false;
+        }
+        emitOp(Op::Constant, 0, value);
+        return true;
+    }
+
+    if (c.isLetter() || c == u'_') {
+        while (parser.pos < text.size() && (text[parser.pos].isLetterOrNumber() || text[parser.pos] == u'_')) {
+            ++parser.pos;
+        }
+        const QStringView name = QStringView(text).mid(start, parser.pos - start);
+        if (name.compare(QLatin1String("pi"), Qt::CaseInsensitive) == 0) {
+            emitOp(Op::Constant, 0, PI);
+            return true;
+        }
+        for (const Identifier &identifier : IDENTIFIERS) {
+            if (name == QLatin1String(identifier.name)) {
+                int input = int(m_inputs.indexOf(identifier.type));
+                if (input < 0) {
+                    input = int(m_inputs.size());
+                    m_inputs.append(identifier.type);
+                }
+                emitOp(Op::Input, input);
+                return true;
+            }
+        }
+        parser.error = QObject::tr("Tuntematon kanava '%1'.").arg(name.toString());
+        return false;
+    }
+
+    parser.error = QObject::tr("Odottamaton merkki '%1' kohdassa %2.").arg(c).arg(start + 1);
+    return false;
+}
+
+double DerivedExpression::evaluate(const double *inputs) const
+{
+    QVarLengthArray<double, 16> stack;
+    for (const Instruction &instruction : m_program) {
+        switch (instruction.op) {
+        case Op::Input:
+            stack.append(inputs[instruction.input]);
+            break;
+        case Op::Constant:
+            stack.append(instruction.constant);
+            break;
+        case Op::Negate:
+            stack.last() = -stack.last();
+            break;
+        default: {
+            const double b = stack.takeLast();
+            double &a = stack.last();
+            switch (instruction.op) {
+            case Op::Add:      a += b; break;
+            case Op::Subtract: a -= b; break;
+            case Op::Multiply: a *= b; break;
+            case Op::Divide:   a /= b; break;
+            default: break;
+            }
+            break;
+        }
+        }
+    }
+    return stack.isEmpty() ? std::nan("") : stack.last();
+}
+
+QVector<double> DerivedExpression::evaluate(const QList<QVector<double>> &columns, qsizetype size) const
+{
+    if (m_program.isEmpty()) {
+        return {};
+    }
+
+    QList<Operand> stack;
+    stack.reserve(m_maxDepth);
+    for (const Instruction &instruction : m_program) {
+        switch (instruction.op) {
+        case Op::Input:
+            stack.append({ columns[instruction.input], 0.0, true });
+            break;
+        case Op::Constant:
+            stack.append({ {}, instruction.constant, false });
+            break;
+        case Op::Negate: {
+            Operand &a = stack.last();
+            if (a.isColumn) {
+                double *out = a.column.data();
+                for (qsizetype i = 0; i < size; ++i) {
+                    out[i] = -out[i];
+                }
+            } else {
+                a.scalar = -a.scalar;
+            }
+            break;
+        }
+        default: {
+            Operand b = stack.takeLast();
+            Operand &a = stack.last();
+            switch (instruction.op) {
+            case Op::Add:      combine(a, b, size, [](double x, double y) { return x + y; }); break;
+            case Op::Subtract: combine(a, b, size, [](double x, double y) { return x - y; }); break;
+            case Op::Multiply: combine(a, b, size, [](double x, double y) { return x * y; }); break;
+            case Op::Divide:   combine(a, b, size, [](double x, double y) { return x / y; }); break;
+            default: break;
+            }
+            break;
+        }
+        }
+    }
+
+    Operand result = stack.takeLast();
+    return result.isColumn ? std::move(result.column) : QVector<double>(size, result.scalar);
+}
@@ -0,0 +1,79 @@
+#ifndef DERIVEDEXPRESSION_H
+#define DERIVEDEXPRESSION_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+#include "sensordata.h"
+
+/**
+ * @class DerivedExpression
+ * @brief Laskennallisen kanavan lauseke käännettynä pinokoneen ohjelmaksi.
+ *
+ * Lausekkeessa voi käyttää anturityyppien nimiä (esim. PRIMARY_AXLE_RPM),
+ * lukuja, vakiota pi, operaattoreita + - * / ja sulkeita. Kääntäminen
+ * tehdään kerran; sama ohjelma lasketaan joko yhdelle näytteelle kerrallaan
+ * (reaaliaikainen data) tai kokonaisille sarakkeille (lokit), jolloin jokainen
+ * operaatio on yksi tiivis silmukka koko sarakkeen yli.
+ */
+class DerivedExpression
+{
+public:
+    /**
+     * @brief Kääntää lausekkeen. Virheen sattuessa lauseke jää tyhjäksi.
+     */
+    bool compile(const QString &text, QString *error = nullptr);
+
+    bool isValid() const { return !m_program.isEmpty(); }
+
+    /**
+     * @brief Lausekkeen syötekanavat ensimmäisen esiintymän järjestyksessä.
+     */
+    const QList<SensorType> &inputs() const { return m_inputs; }
+
+    /**
+     * @brief Laskee arvon yhdelle hetkelle. @p inputs on inputs():n järjestyksessä.
+     */
+    double evaluate(const double *inputs) const;
+
+    /**
+     * @brief Laskee arvot sarakkeittain. Jokaisessa sarakkeessa on @p size riviä.
+     */
+    QVector<double> evaluate(const QList<QVector<double>> &columns, qsizetype size) const;
+
+private:
+    enum class Op : quint8 {
+        Input,
+        Constant,
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Negate
+    };
+
+    struct Instruction {
+        Op op;
+        int input;       // Op::Input
+        double constant; // Op::Constant
+    };
+
+    struct Parser {
+        QString text;
+        int pos = 0;
+        QString error;
+    };
+
+    bool parseSum(Parser &parser);
+    bool parseProduct(Parser &parser);
+    bool parseUnary(Parser &parser);
+    bool parsePrimary(Parser &parser);
+    void emitOp(Op op, int input = 0, double constant = 0.0);
+
+    QList<Instruction> m_program;
+    QList<SensorType> m_inputs;
+    int m_depth = 0;
+    int m_maxDepth = 0;
+};
+
+#endif // DERIVEDEXPRESSION_H
@@ -0,0 +1,258 @@
+#include "frameparser.h"
+
+#include <array>
+#include <cstring>
+
+namespace {
+
+// CRC-16/CCITT-taulukko (polynomi 0x1021) lasketaan käännösaikana
+constexpr std::array<quint16, 256> makeCrc16Table()
+{
+    std::array<quint16, 256> table {};
+    for (int i = 0; i < 256; ++i) {
+        quint16 crc = quint16(i << 8);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? quint16((crc << 1) ^ 0x1021) : quint16(crc << 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr std::array<quint16, 256> CRC16_TABLE = makeCrc16Table();
+
+} // namespace
+
+FrameParser::FrameParser()
+{
+    reset();
+}
+
+void FrameParser::reset()
+{
+    m_readPos = 0;
+    m_writePos = 0;
+    m_scanPos = 0;
+    m_state = State::SeekStart;
+    m_frameLength = 0;
+    m_skippedBytes = 0;
+    m_checksumErrors = 0;
+}
+
+void FrameParser::setProtocol(Protocol protocol)
+{
+    m_protocol = protocol;
+    m_state = State::SeekStart;
+    m_scanPos = m_readPos;
+}
+
+quint16 FrameParser::crc16(const quint8 *data, int size, quint16 crc)
+{
+    for (int i = 0; i < size; ++i) {
+        crc = quint16((crc << 8) ^ CRC16_TABLE[quint8(crc >> 8) ^ data[i]]);
+    }
+    return crc;
+}
+
+char *FrameParser::writePointer()
+{
+    return reinterpret_cast<char *>(m_data + (m_writePos & Mask));
+}
+
+int FrameParser::writableSize() const
+{
+    const quint32 free = Capacity - (m_writePos - m_readPos);
+    const quint32 untilEnd = Capacity - (m_writePos & Mask);
+    return int(qMin(free, untilEnd));
+}
+
+void FrameParser::commit(int bytes)
+{
+    m_writePos += quint32(bytes);
+}
+
+int FrameParser::write(const char *data, int size)
+{
+    int written = 0;
+    while (written < size) {
+        const int chunk = qMin(writableSize(), size - written);
+        if (chunk <= 0) {
+            break;
+        }
+        std::memcpy(writePointer(), data + written, size_t(chunk));
+        commit(chunk);
+        written += chunk;
+    }
+    return written;
+}
+
+bool FrameParser::seekStart()
+{
+    // Etsitään aloitusmerkki memchr:llä puskurin yhtenäisistä osista
+    while (m_readPos != m_writePos) {
+        const quint32 offset = m_readPos & Mask;
+        const quint32 contiguous = qMin(m_writePos - m_readPos, Capacity - offset);
+        const void *hit = std::memchr(m_data + offset, START_BYTE, contiguous);
+        if (hit) {
+            const quint32 skipped = quint32(static_cast<const quint8 *>(hit) - (m_data + offset));
+            m_readPos += skipped;
+            m_skippedBytes += skipped;
+            return true;
+        }
+        m_readPos += contiguous;
+        m_skippedBytes += contiguous;
+    }
+    return false;
+}
+
+void FrameParser::copyOut(quint32 pos, quint8 *dst, quint32 count) const
+{
+    const quint32 offset = pos & Mask;
+    const quint32 first = qMin(count, Capacity - offset);
+    std::memcpy(dst, m_data + offset, first);
+    std::memcpy(dst + first, m_data, count - first);
+}
+
+bool FrameParser::next(Frame &frame)
+{
+    return m_protocol == Protocol::V2 ? nextV2(frame) : nextV1(frame);
+}
+
+bool FrameParser::nextV1(Frame &frame)
+{
+    for (;;) {
+        switch (m_state) {
+        case State::SeekStart:
+            if (!seekStart()) {
+                return false;
+            }
+            m_state = State::Header;
+            Q_FALLTHROUGH();
+
+        case State::Header:
+            // Tarvitaanko lisää dataa headerille?
+            if (m_writePos - m_readPos < HeaderSize) {
+                return false;
+            }
+            m_frameLength = byteAt(m_readPos + 2);
+            m_state = State::Body;
+            Q_FALLTHROUGH();
+
+        case State::Body: {
+            const quint32 packetSize = HeaderSize + m_frameLength + 1; // header + payload + checksum
+            if (m_writePos - m_readPos < packetSize) {
+                return false; // Odota lisää dataa
+            }
+
+            // XOR-lasku start-tavusta payloadin loppuun
+            quint8 checksum = 0;
+            for (quint32 i = 0; i < packetSize - 1; ++i) {
+                checksum ^= byteAt(m_readPos + i);
+            }
+
+            m_state = State::SeekStart;
+            if (checksum != byteAt(m_readPos + packetSize - 1)) {
+                // Väärä aloitusmerkki tai vioittunut kehys: ohitetaan vain
+                // aloitusmerkki, jotta sen sisällä mahdollisesti alkava oikea
+                // kehys löytyy.
+                ++m_readPos;
+                ++m_skippedBytes;
+                ++m_checksumErrors;
+                continue;
+            }
+
+            frame.type = byteAt(m_readPos + 1);
+            frame.length = m_frameLength;
+            copyOut(m_readPos + HeaderSize, frame.payload, m_frameLength);
+            m_readPos += packetSize;
+            return true;
+        }
+        }
+    }
+}
+
+bool FrameParser::findDelimiter(quint32 &position)
+{
+    // Jatketaan siitä, mihin edellinen haku jäi, jotta osittain saapunutta
+    // kehystä ei käydä läpi uudelleen jokaisella luvulla
+    quint32 pos = (m_scanPos - m_readPos) <= (m_writePos - m_readPos) ? m_scanPos : m_readPos;
+    while (pos != m_writePos) {
+        const quint32 offset = pos & Mask;
+        const quint32 contiguous = qMin(m_writePos - pos, Capacity - offset);
+        const void *hit = std::memchr(m_data + offset, DELIMITER, contiguous);
+        if (hit) {
+            position = pos + quint32(static_cast<const quint8 *>(hit) - (m_data + offset));
+            return true;
+        }
+        pos += contiguous;
+    }
+    m_scanPos = pos;
+    return false;
+}
+
+bool FrameParser::decodeCobs(quint32 begin, quint32 end, Frame &frame) const
+{
+    quint8 decoded[MaxDecodedSize];
+    quint32 size = 0;
+    quint32 pos = begin;
+    while (pos != end) {
+        const quint8 code = byteAt(pos++);
+        // code - 1 datatavua, jonka jälkeen nolla, ellei lohko ole täysi tai viimeinen
+        if (code == 0 || code - 1u > end - pos || size + code - 1u > MaxDecodedSize) {
+            return false;
+        }
+        for (quint8 i = 1; i < code; ++i) {
+            decoded[size++] = byteAt(pos++);
+        }
+        if (code != 0xFF && pos != end) {
+            if (size == MaxDecodedSize) {
+                return false;
+            }
+            decoded[size++] = 0;
+        }
+    }
+
+    if (size < 3) {
+        return false;
+    }
+    const quint32 dataSize = size - 2;
+    const quint16 crc = quint16(decoded[dataSize] | (decoded[dataSize + 1] << 8));
+    if (crc16(decoded, int(dataSize)) != crc) {
+        return false;
+    }
+
+    frame.type = decoded[0];
+    frame.length = quint8(dataSize - 1);
+    std::memcpy(frame.payload, decoded + 1, dataSize - 1);
+    return true;
+}
+
+bool FrameParser::nextV2(Frame &frame)
+{
+    quint32 delimiter;
+    while (findDelimiter(delimiter)) {
+        const quint32 begin = m_readPos;
+        const quint32 encodedSize = delimiter - begin;
+        m_readPos = delimiter + 1;
+        m_scanPos = m_readPos;
+
+        if (encodedSize == 0) {
+            continue; // Peräkkäiset erottimet, esim. linjan alussa
+        }
+        if (decodeCobs(begin, delimiter, frame)) {
+            return true;
+        }
+
+        // Vioittunut kehys: seuraava alkaa varmasti erottimen jälkeen
+        m_skippedBytes += encodedSize + 1;
+        ++m_checksumErrors;
+    }
+
+    // Ilman erotinta kertynyt data ei voi olla ehjä kehys
+    if (m_writePos - m_readPos > MaxEncodedSize) {
+        m_skippedBytes += m_writePos - m_readPos;
+        m_readPos = m_writePos;
+        m_scanPos = m_writePos;
+    }
+    return false;
+}
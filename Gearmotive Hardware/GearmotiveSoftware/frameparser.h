@@ -0,0 +1,135 @@
+#ifndef FRAMEPARSER_H
+#define FRAMEPARSER_H
+
+#include <QtGlobal>
+
+/**
+ * @class FrameParser
+ * @brief Kiinteän kokoinen rengaspuskuri ja tilakonepohjainen kehysjäsennin.
+ *
+ * Sarjaportilta luetut tavut kirjoitetaan suoraan rengaspuskuriin, ja kehykset
+ * jäsennetään paikallaan luku-kursorien avulla. Jäsennys ei varaa muistia
+ * kehystä kohden eikä siirrä puskurin sisältöä.
+ *
+ * Kehyksen formaatti, versio 1:
+ * - 1 tavu: Aloitusmerkki (0xAA)
+ * - 1 tavu: Anturin tyyppi
+ * - 1 tavu: Datan pituus
+ * - N tavua: Data
+ * - 1 tavu: Tarkistussumma (XOR)
+ *
+ * Versio 2: COBS-koodattu (tyyppi, data, CRC-16/CCITT-FALSE little-endian)
+ * ja perään erotin 0x00. Kehysraja löytyy aina seuraavasta nollatavusta,
+ * joten vioittunut kehys ei vaikuta seuraavaan.
+ */
+class FrameParser
+{
+public:
+    static constexpr quint32 Capacity = 4096; ///< Puskurin koko, oltava kahden potenssi.
+    static constexpr int MaxPayload = 255;    ///< Suurin mahdollinen datan pituus.
+
+    /**
+     * @brief Kehysformaatin versio. Arvot vastaavat laitteen ProtocolVersion-enumia.
+     */
+    enum class Protocol : quint8 {
+        V1 = 1, ///< Aloitusmerkki ja XOR-tarkistussumma.
+        V2 = 2  ///< COBS ja CRC-16.
+    };
+
+    /**
+     * @brief Yksi jäsennetty kehys. Data kopioidaan kiinteään taulukkoon.
+     */
+    struct Frame {
+        quint8 type;
+        quint8 length;
+        quint8 payload[MaxPayload];
+    };
+
+    FrameParser();
+
+    /**
+     * @brief Palauttaa osoittimen puskurin seuraavaan yhtenäiseen vapaaseen alueeseen.
+     */
+    char *writePointer();
+
+    /**
+     * @brief Palauttaa writePointer():n osoittaman yhtenäisen vapaan alueen koon.
+     */
+    int writableSize() const;
+
+    /**
+     * @brief Merkitsee @p bytes tavua kirjoitetuiksi writePointer():n kautta.
+     */
+    void commit(int bytes);
+
+    /**
+     * @brief Kopioi dataa puskuriin niin paljon kuin mahtuu.
+     * @return Kirjoitettujen tavujen määrä.
+     */
+    int write(const char *data, int size);
+
+    /**
+     * @brief Vaihtaa kehysformaatin. Puskurissa jo oleva data jäsennetään uudella formaatilla.
+     */
+    void setProtocol(Protocol protocol);
+    Protocol protocol() const { return m_protocol; }
+
+    /**
+     * @brief Laskee CRC-16/CCITT-FALSE-tarkistussumman taulukon avulla.
+     */
+    static quint16 crc16(const quint8 *data, int size, quint16 crc = 0xFFFF);
+
+    /**
+     * @brief Jäsentää seuraavan kokonaisen kehyksen puskurista.
+     * @param frame Kehys, johon tulos kirjoitetaan.
+     * @return true, jos kehys löytyi; false, jos tarvitaan lisää dataa.
+     */
+    bool next(Frame &frame);
+
+    /**
+     * @brief Tyhjentää puskurin ja palauttaa tilakoneen alkutilaan. Protokollaversio säilyy.
+     */
+    void reset();
+
+    int size() const { return int(m_writePos - m_readPos); }
+    quint64 skippedBytes() const { return m_skippedBytes; }
+    quint64 checksumErrors() const { return m_checksumErrors; } ///< XOR- tai CRC-virheet sekä viallinen COBS-koodaus.
+
+private:
+    enum class State {
+        SeekStart,
+        Header,
+        Body
+    };
+
+    static constexpr quint32 Mask = Capacity - 1;
+    static constexpr quint32 HeaderSize = 3; // start + type + len
+    static constexpr quint8 START_BYTE = 0xAA;
+    static constexpr quint8 DELIMITER = 0x00;
+    static constexpr quint32 MaxDecodedSize = 1 + MaxPayload + 2;  // tyyppi + data + CRC
+    static constexpr quint32 MaxEncodedSize = MaxDecodedSize + 2; // COBS-ylimäärä
+
+    static_assert((Capacity & Mask) == 0, "Capacity must be a power of two");
+    static_assert(Capacity > HeaderSize + MaxPayload + 1, "Capacity must hold a full frame");
+    static_assert(Capacity > MaxEncodedSize + 1, "Capacity must hold a full frame");
+
+    quint8 byteAt(quint32 pos) const { return m_data[pos & Mask]; }
+    bool nextV1(Frame &frame);
+    bool nextV2(Frame &frame);
+    bool seekStart();
+    bool findDelimiter(quint32 &position);
+    bool decodeCobs(quint32 begin, quint32 end, Frame &frame) const;
+    void copyOut(quint32 pos, quint8 *dst, quint32 count) const;
+
+    quint8 m_data[Capacity];
+    quint32 m_readPos;  // Kasvavat laskurit, indeksi saadaan maskilla
+    quint32 m_writePos;
+    quint32 m_scanPos;  // Versio 2: tähän asti etsitty erotinta turhaan
+    Protocol m_protocol = Protocol::V1;
+    State m_state;
+    quint8 m_frameLength;
+    quint64 m_skippedBytes;
+    quint64 m_checksumErrors;
+};
+
+#endif // FRAMEPARSER_H
@@ -0,0 +1,197 @@
+#include "gorillacodec.h"
+
+#include <QtAlgorithms>
+#include <cstring>
+
+namespace {
+
+quint64 doubleBits(double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsToDouble(quint64 bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool fitsSigned(qint64 value, int width)
+{
+    const qint64 limit = qint64(1) << (width - 1);
+    return value >= -limit && value < limit;
+}
+
+qint64 signExtend(quint64 bits, int width)
+{
+    const quint64 sign = quint64(1) << (width - 1);
+    return qint64((bits ^ sign) - sign);
+}
+
+} // namespace
+
+// ------ GorillaEncoder ------
+
+void GorillaEncoder::writeBits(quint64 bits, int width)
+{
+    if (width > 32) {
+        writeBits(bits >> 32, width - 32);
+        width = 32;
+    }
+    const quint64 mask = (quint64(1) << width) - 1;
+    m_accumulator = (m_accumulator << width) | (bits & mask);
+    m_pending += width;
+    while (m_pending >= 8) {
+        m_pending -= 8;
+        m_out.append(char(quint8(m_accumulator >> m_pending)));
+    }
+}
+
+void GorillaEncoder::append(qint64 timestampMs, double value)
+{
+    const quint64 valueBits = doubleBits(value);
+
+    if (m_count == 0) {
+        writeBits(quint64(timestampMs), 64);
+        writeBits(valueBits, 64);
+        m_previousTimestamp = timestampMs;
+        m_previousValue = valueBits;
+        ++m_count;
+        return;
+    }
+
+    const qint64 delta = timestampMs - m_previousTimestamp;
+    const qint64 deltaOfDelta = delta - m_previousDelta;
+    if (deltaOfDelta == 0) {
+        writeBits(0b0, 1);
+    } else if (fitsSigned(deltaOfDelta, 7)) {
+        writeBits(0b10, 2);
+        writeBits(quint64(deltaOfDelta), 7);
+    } else if (fitsSigned(deltaOfDelta, 9)) {
+        writeBits(0b110, 3);
+        writeBits(quint64(deltaOfDelta), 9);
+    } else if (fitsSigned(deltaOfDelta, 12)) {
+        writeBits(0b1110, 4);
+        writeBits(quint64(deltaOfDelta), 12);
+    } else {
+        writeBits(0b1111, 4);
+        writeBits(quint64(deltaOfDelta), 64);
+    }
+    m_previousTimestamp = timestampMs;
+    m_previousDelta = delta;
+
+    const quint64 xorBits = valueBits ^ m_previousValue;
+    if (xorBits == 0) {
+        writeBits(0b0, 1);
+    } else {
+        const int leading = qMin(int(qCountLeadingZeroBits(xorBits)), 31);
+        const int trailing = int(qCountTrailingZeroBits(xorBits));
+        if (m_leading >= 0 && leading >= m_leading && trailing >= m_trailing) {
+            // Mahtuu edelliseen ikkunaan, ikkunan kuvausta ei toisteta
+            writeBits(0b10, 2);
+            writeBits(xorBits >> m_trailing, 64 - m_leading - m_trailing);
+        } else {
+            const int significant = 64 - leading - trailing;
+            writeBits(0b11, 2);
+            writeBits(quint64(leading), 5);
+            writeBits(quint64(significant & 63), 6); // 64 tallennetaan nollana
+            writeBits(xorBits >> trailing, significant);
+            m_leading = leading;
+            m_trailing = trailing;
+        }
+    }
+    m_previousValue = valueBits;
+    ++m_count;
+}
+
+QByteArray GorillaEncoder::finish()
+{
+    if (m_pending > 0) {
+        m_out.append(char(quint8(m_accumulator << (8 - m_pending))));
+    }
+    QByteArray out = m_out;
+    *this = GorillaEncoder();
+    return out;
+}
+
+// ------ GorillaDecoder ------
+
+GorillaDecoder::GorillaDecoder(const char *data, qsizetype size, quint32 count)
+    : m_data(reinterpret_cast<const quint8 *>(data)), m_size(size), m_remaining(count)
+{
+}
+
+quint64 GorillaDecoder::readBits(int width)
+{
+    if (m_bitPos + width > m_size * 8) {
+        m_error = true;
+        return 0;
+    }
+
+    quint64 result = 0;
+    while (width > 0) {
+        const int available = 8 - int(m_bitPos & 7);
+        const int take = qMin(width, available);
+        const quint8 byte = m_data[m_bitPos >> 3];
+        result = (result << take) | ((byte >> (available - take)) & ((1u << take) - 1));
+        width -= take;
+        m_bitPos += take;
+    }
+    return result;
+}
+
+bool GorillaDecoder::next(qint64 &timestampMs, double &value)
+{
+    if (m_remaining == 0 || m_error) {
+        return false;
+    }
+
+    if (m_index == 0) {
+        m_timestamp = qint64(readBits(64));
+        m_value = readBits(64);
+    } else {
+        qint64 deltaOfDelta = 0;
+        if (readBit()) {
+            if (!readBit()) {
+                deltaOfDelta = signExtend(readBits(7), 7);
+            } else if (!readBit()) {
+                deltaOfDelta = signExtend(readBits(9), 9);
+            } else if (!readBit()) {
+                deltaOfDelta = signExtend(readBits(12), 12);
+            } else {
+                deltaOfDelta = qint64(readBits(64));
+            }
+        }
+        m_delta += deltaOfDelta;
+        m_timestamp += m_delta;
+
+        if (readBit()) {
+            if (readBit()) {
+                m_leading = int(readBits(5));
+                int significant = int(readBits(6));
+                if (significant == 0) {
+                    significant = 64;
+                }
+                m_trailing = 64 - m_leading - significant;
+                if (m_trailing < 0) {
+                    m_error = true;
+                    return false;
+                }
+            }
+            const int significant = 64 - m_leading - m_trailing;
+            m_value ^= readBits(significant) << m_trailing;
+        }
+    }
+
+    if (m_error) {
+        return false;
+    }
+    ++m_index;
+    --m_remaining;
+    timestampMs = m_timestamp;
+    value = bitsToDouble(m_value);
+    return true;
+}
@@ -0,0 +1,98 @@
+#ifndef GORILLACODEC_H
+#define GORILLACODEC_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+/*
+ * Aikasarjan pakkaus Facebookin Gorilla-tietokannan tapaan.
+ *
+ * Aikaleimoista tallennetaan erotusten erotus (delta-of-delta), joka
+ * tasaisella näytevälillä on lähes aina nolla ja vie yhden bitin:
+ * - '0'                 erotus sama kuin edellinen
+ * - '10'   + 7 bittiä   [-64, 63]
+ * - '110'  + 9 bittiä   [-256, 255]
+ * - '1110' + 12 bittiä  [-2048, 2047]
+ * - '1111' + 64 bittiä  muut (esim. kellon uudelleensidonta)
+ *
+ * Arvoista tallennetaan XOR edelliseen arvoon. Hitaasti muuttuvassa
+ * signaalissa XORissa on paljon nollia molemmissa päissä:
+ * - '0'                          sama arvo
+ * - '10' + merkitsevät bitit     mahtuu edellisen arvon bittiikkunaan
+ * - '11' + 5 bittiä johtavat nollat + 6 bittiä pituus + merkitsevät bitit
+ *
+ * Ensimmäinen aikaleima ja arvo tallennetaan sellaisenaan (64 bittiä), ja
+ * ensimmäisen erotuksen vertailukohtana on nolla. Etumerkilliset kentät
+ * ovat kahden komplementtimuodossa.
+ * Bitit kirjoitetaan tavuihin eniten merkitsevästä alkaen.
+ */
+
+/**
+ * @class GorillaEncoder
+ * @brief Pakkaa yhden kanavan näytteet tavujonoksi.
+ */
+class GorillaEncoder
+{
+public:
+    void append(qint64 timestampMs, double value);
+
+    /**
+     * @brief Palauttaa pakatun datan ja aloittaa uuden lohkon.
+     */
+    QByteArray finish();
+
+    int count() const { return m_count; }
+
+private:
+    void writeBits(quint64 bits, int width);
+
+    QByteArray m_out;
+    quint64 m_accumulator = 0; // Kirjoittamattomat bitit, vähiten merkitsevissä biteissä
+    int m_pending = 0;
+    int m_count = 0;
+
+    qint64 m_previousTimestamp = 0;
+    qint64 m_previousDelta = 0;
+    quint64 m_previousValue = 0;
+    int m_leading = -1; // Edellisen XORin bittiikkuna; -1 = ei vielä ikkunaa
+    int m_trailing = 0;
+};
+
+/**
+ * @class GorillaDecoder
+ * @brief Purkaa GorillaEncoderin tuottaman datan näyte kerrallaan.
+ *
+ * Dataa ei kopioida, joten puskurin on pysyttävä voimassa purun ajan.
+ */
+class GorillaDecoder
+{
+public:
+    GorillaDecoder(const char *data, qsizetype size, quint32 count);
+
+    /**
+     * @brief Purkaa seuraavan näytteen.
+     * @return false, kun näytteet loppuivat tai data on viallinen.
+     */
+    bool next(qint64 &timestampMs, double &value);
+
+    bool hasError() const { return m_error; }
+
+private:
+    quint64 readBits(int width);
+    bool readBit() { return readBits(1) != 0; }
+
+    const quint8 *m_data;
+    qsizetype m_size;
+    qsizetype m_bitPos = 0;
+    quint32 m_remaining;
+    quint32 m_index = 0;
+    bool m_error = false;
+
+    qint64 m_timestamp = 0;
+    qint64 m_delta = 0;
+    quint64 m_value = 0;
+    int m_leading = 0;
+    int m_trailing = 0;
+};
+
+#endif // GORILLACODEC_H
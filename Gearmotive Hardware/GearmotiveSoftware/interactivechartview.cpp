@@ -119,4 +119,10 @@ void InteractiveChartView::mouseReleaseEvent(QMouseEvent *event)
     } else {
         QChartView::mouseReleaseEvent(event);
     }
-} 
\ No newline at end of file
+} 
+
+void InteractiveChartView::resizeEvent(QResizeEvent *event)
+{
+    QChartView::resizeEvent(event);
+    emit viewChanged();
+}
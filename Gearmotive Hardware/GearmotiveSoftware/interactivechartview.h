@@ -3,6 +3,7 @@
 
 #include <QtCharts/QChartView>
 #include <QMouseEvent>
+#include <QResizeEvent>
 #include <QWheelEvent>
 
 
@@ -62,6 +63,12 @@ protected:
      */
     void mouseReleaseEvent(QMouseEvent *event) override;
 
+    /**
+     * @brief Ilmoittaa koon muutoksesta viewChanged-signaalilla, koska piirtoalueen leveys muuttuu.
+     * @param event Koon muutostapahtuma.
+     */
+    void resizeEvent(QResizeEvent *event) override;
+
 private:
     bool m_isPanning;      ///< Kertoo, onko panorointi käynnissä.
     bool m_isDraggingRight; ///< Kertoo, onko hiiren oikean painikkeen veto käynnissä.
@@ -0,0 +1,108 @@
+#include "livechannelbuffer.h"
+
+LiveChannelBuffer::LiveChannelBuffer(qsizetype capacity)
+{
+    qsizetype rounded = 1;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+    m_timestamps.resize(rounded);
+    m_values.resize(rounded);
+    m_mask = rounded - 1;
+}
+
+void LiveChannelBuffer::append(qint64 timestampMs, double value)
+{
+    const qsizetype position = (m_start + m_size) & m_mask;
+    m_timestamps[position] = timestampMs;
+    m_values[position] = value;
+    if (m_size == capacity()) {
+        m_start = (m_start + 1) & m_mask; // Vanhin näyte korvautui
+    } else {
+        ++m_size;
+    }
+}
+
+void LiveChannelBuffer::clear()
+{
+    m_start = 0;
+    m_size = 0;
+}
+
+qsizetype LiveChannelBuffer::lowerBound(qint64 timestampMs) const
+{
+    qsizetype low = 0;
+    qsizetype high = m_size;
+    while (low < high) {
+        const qsizetype middle = low + (high - low) / 2;
+        if (timestampAt(middle) < timestampMs) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+QList<QPointF> LiveChannelBuffer::decimate(qint64 fromMs, qint64 toMs, int pixelWidth,
+                                           double &minValue, double &maxValue) const
+{
+    QList<QPointF> points;
+    minValue = 0.0;
+    maxValue = 0.0;
+    const qsizetype first = lowerBound(fromMs);
+    const qsizetype end = lowerBound(toMs + 1);
+    if (first >= end) {
+        return points;
+    }
+
+    const auto point = [this](qsizetype index) {
+        return QPointF(timestampAt(index), valueAt(index));
+    };
+
+    minValue = valueAt(first);
+    maxValue = minValue;
+    pixelWidth = qMax(pixelWidth, 1);
+    points.reserve(qMin(end - first, 4 * qsizetype(pixelWidth)) + 1);
+
+    // Edellinen näyte vie viivan piirtoalueen vasempaan reunaan
+    if (first > 0) {
+        points.append(point(first - 1));
+    }
+
+    // Jokaisesta pikselisarakkeesta ensimmäinen, pienin, suurin ja viimeinen
+    // näyte, jotta lyhyetkin piikit näkyvät
+    const qint64 span = toMs - fromMs + 1;
+    qsizetype index = first;
+    for (int column = 0; column < pixelWidth && index < end; ++column) {
+        const qint64 columnEndMs = fromMs + span * (column + 1) / pixelWidth;
+        const qsizetype columnBegin = index;
+        qsizetype minIndex = index;
+        qsizetype maxIndex = index;
+        while (index < end && timestampAt(index) < columnEndMs) {
+            const double value = valueAt(index);
+            if (value < valueAt(minIndex)) {
+                minIndex = index;
+            }
+            if (value > valueAt(maxIndex)) {
+                maxIndex = index;
+            }
+            ++index;
+        }
+        if (index == columnBegin) {
+            continue;
+        }
+
+        minValue = qMin(minValue, valueAt(minIndex));
+        maxValue = qMax(maxValue, valueAt(maxIndex));
+        const qsizetype indices[4] = { columnBegin, qMin(minIndex, maxIndex), qMax(minIndex, maxIndex), index - 1 };
+        qsizetype previous = -1;
+        for (qsizetype i : indices) {
+            if (i != previous) {
+                points.append(point(i));
+                previous = i;
+            }
+        }
+    }
+    return points;
+}
@@ -0,0 +1,56 @@
+#ifndef LIVECHANNELBUFFER_H
+#define LIVECHANNELBUFFER_H
+
+#include <QList>
+#include <QPointF>
+#include <QVector>
+
+/**
+ * @class LiveChannelBuffer
+ * @brief Kiinteän kokoinen rengaspuskuri yhden kanavan reaaliaikaisille näytteille.
+ *
+ * Muisti varataan kerran konstruktorissa; täyden puskurin vanhin näyte
+ * korvautuu uudella. Näin pitkäkään mittaus ei kasvata muistinkäyttöä.
+ * Indeksi 0 on vanhin puskurissa oleva näyte.
+ */
+class LiveChannelBuffer
+{
+public:
+    static constexpr qsizetype DefaultCapacity = 1 << 17; ///< Esim. 100 Hz kanavalle noin 20 min.
+
+    /**
+     * @param capacity Näytteiden enimmäismäärä, pyöristetään ylöspäin kahden potenssiin.
+     */
+    explicit LiveChannelBuffer(qsizetype capacity = DefaultCapacity);
+
+    void append(qint64 timestampMs, double value);
+    void clear();
+
+    qsizetype size() const { return m_size; }
+    qsizetype capacity() const { return m_timestamps.size(); }
+    bool isEmpty() const { return m_size == 0; }
+    qint64 timestampAt(qsizetype index) const { return m_timestamps[(m_start + index) & m_mask]; }
+    double valueAt(qsizetype index) const { return m_values[(m_start + index) & m_mask]; }
+    qint64 lastMs() const { return timestampAt(m_size - 1); }
+
+    /**
+     * @brief Ensimmäinen näyte, jonka aikaleima on vähintään @p timestampMs.
+     */
+    qsizetype lowerBound(qint64 timestampMs) const;
+
+    /**
+     * @brief Aikavälin [fromMs, toMs] pisteet pikselisarakkeittain (ensimmäinen, min, max, viimeinen).
+     * @param minValue Palauttaa välin pienimmän arvon.
+     * @param maxValue Palauttaa välin suurimman arvon.
+     */
+    QList<QPointF> decimate(qint64 fromMs, qint64 toMs, int pixelWidth, double &minValue, double &maxValue) const;
+
+private:
+    QVector<qint64> m_timestamps;
+    QVector<double> m_values;
+    qsizetype m_mask;
+    qsizetype m_start = 0; // Vanhimman näytteen fyysinen indeksi
+    qsizetype m_size = 0;
+};
+
+#endif // LIVECHANNELBUFFER_H
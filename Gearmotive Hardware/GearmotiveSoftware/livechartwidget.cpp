@@ -0,0 +1,145 @@
+#include "livechartwidget.h"
+
+#include <QComboBox>
+#include <QDateTime>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QSpinBox>
+#include <QTimer>
+#include <QVBoxLayout>
+
+LiveChartWidget::LiveChartWidget(QWidget *parent)
+    : QWidget(parent)
+    , m_channelBox(new QComboBox(this))
+    , m_windowBox(new QSpinBox(this))
+    , m_view(new QChartView(this))
+    , m_chart(new QChart())
+    , m_series(new QLineSeries())
+    , m_axisX(new QDateTimeAxis())
+    , m_axisY(new QValueAxis())
+    , m_redrawTimer(new QTimer(this))
+{
+    for (SensorType type : registeredSensors()) {
+        const SensorInfo &info = sensorInfo(type);
+        m_channelBox->addItem(info.unit.isEmpty() ? info.name : QString("%1 (%2)").arg(info.name, info.unit),
+                              int(type));
+    }
+    // Oletuksena vääntö, jonka piikit halutaan nähdä heti
+    const int torqueIndex = m_channelBox->findData(int(SensorType::GEARBOX_TORQUE));
+    if (torqueIndex >= 0) {
+        m_channelBox->setCurrentIndex(torqueIndex);
+    }
+
+    m_windowBox->setRange(1, MaxWindowSeconds);
+    m_windowBox->setValue(30);
+    m_windowBox->setSuffix(tr(" s"));
+
+    QHBoxLayout *controls = new QHBoxLayout;
+    controls->addWidget(new QLabel(tr("Kanava:"), this));
+    controls->addWidget(m_channelBox);
+    controls->addSpacing(16);
+    controls->addWidget(new QLabel(tr("Aikaikkuna:"), this));
+    controls->addWidget(m_windowBox);
+    controls->addStretch();
+
+    m_chart->addSeries(m_series);
+    m_axisX->setFormat("hh:mm:ss");
+    m_axisX->setTickCount(7);
+    m_chart->addAxis(m_axisX, Qt::AlignBottom);
+    m_chart->addAxis(m_axisY, Qt::AlignLeft);
+    m_series->attachAxis(m_axisX);
+    m_series->attachAxis(m_axisY);
+    m_chart->legend()->hide();
+    m_view->setChart(m_chart);
+    m_view->setRenderHint(QPainter::Antialiasing);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addLayout(controls);
+    layout->addWidget(m_view, 1);
+
+    connect(m_channelBox, &QComboBox::currentIndexChanged, this, &LiveChartWidget::onChannelChanged);
+    connect(m_windowBox, &QSpinBox::valueChanged, this, [this]() {
+        m_dirty = true;
+    });
+    connect(m_redrawTimer, &QTimer::timeout, this, &LiveChartWidget::redraw);
+    m_redrawTimer->start(RedrawIntervalMs);
+    onChannelChanged();
+}
+
+void LiveChartWidget::setWindowSeconds(int seconds)
+{
+    m_windowBox->setValue(seconds);
+}
+
+int LiveChartWidget::windowSeconds() const
+{
+    return m_windowBox->value();
+}
+
+SensorType LiveChartWidget::selectedType() const
+{
+    return static_cast<SensorType>(m_channelBox->currentData().toInt());
+}
+
+void LiveChartWidget::addSamples(const QList<SensorSample> &samples)
+{
+    // Vain puskurointi; piirto tapahtuu ajastimella
+    for (const SensorSample &sample : samples) {
+        std::unique_ptr<LiveChannelBuffer> &buffer = m_buffers[quint8(sample.type)];
+        if (!buffer) {
+            buffer = std::make_unique<LiveChannelBuffer>();
+        }
+        buffer->append(sample.timestampMs, sample.value);
+        if (sample.type == selectedType()) {
+            m_dirty = true;
+        }
+    }
+}
+
+void LiveChartWidget::clear()
+{
+    for (std::unique_ptr<LiveChannelBuffer> &buffer : m_buffers) {
+        if (buffer) {
+            buffer->clear();
+        }
+    }
+    m_series->clear();
+    m_dirty = false;
+}
+
+void LiveChartWidget::onChannelChanged()
+{
+    const SensorInfo &info = sensorInfo(selectedType());
+    m_chart->setTitle(info.name);
+    m_axisY->setTitleText(info.unit);
+    m_series->clear();
+    m_dirty = true;
+}
+
+void LiveChartWidget::redraw()
+{
+    if (!m_dirty || !isVisible()) {
+        return; // Piirretään, kun välilehti tulee näkyviin
+    }
+    m_dirty = false;
+
+    const LiveChannelBuffer *buffer = m_buffers[quint8(selectedType())].get();
+    if (!buffer || buffer->isEmpty()) {
+        return;
+    }
+
+    // Ikkunan oikea reuna on uusin näyte
+    const qint64 toMs = buffer->lastMs();
+    const qint64 fromMs = toMs - qint64(m_windowBox->value()) * 1000;
+    const int plotWidth = int(m_chart->plotArea().width());
+    const int pixelWidth = plotWidth > 1 ? plotWidth : m_view->width();
+
+    double minValue;
+    double maxValue;
+    m_series->replace(buffer->decimate(fromMs, toMs, pixelWidth, minValue, maxValue));
+
+    m_axisX->setRange(QDateTime::fromMSecsSinceEpoch(fromMs), QDateTime::fromMSecsSinceEpoch(toMs));
+    const double margin = maxValue > minValue ? (maxValue - minValue) * 0.05 : 1.0;
+    m_axisY->setRange(minValue - margin, maxValue + margin);
+}
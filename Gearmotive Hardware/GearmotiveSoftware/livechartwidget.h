@@ -0,0 +1,70 @@
+#ifndef LIVECHARTWIDGET_H
+#define LIVECHARTWIDGET_H
+
+#include <QWidget>
+#include <QList>
+#include <QtCharts/QChart>
+#include <QtCharts/QChartView>
+#include <QtCharts/QDateTimeAxis>
+#include <QtCharts/QLineSeries>
+#include <QtCharts/QValueAxis>
+#include <array>
+#include <memory>
+#include "livechannelbuffer.h"
+#include "sensordata.h"
+
+class QComboBox;
+class QSpinBox;
+class QTimer;
+
+/**
+ * @class LiveChartWidget
+ * @brief Reaaliaikainen, vierivä kaavio valitusta kanavasta.
+ *
+ * Vastaanotetut näytteet tallennetaan kanavakohtaisiin kiinteän kokoisiin
+ * rengaspuskureihin (LiveChannelBuffer). Kaavio piirretään uudelleen
+ * ajastimella näytön päivitystahdissa eikä jokaisen paketin kohdalla, ja
+ * sarjaan viedään vain näkyvän aikaikkunan pikselisarakkeittain
+ * harvennetut pisteet. Muistinkäyttö pysyy vakiona mittauksen pituudesta
+ * riippumatta.
+ */
+class LiveChartWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit LiveChartWidget(QWidget *parent = nullptr);
+
+    /**
+     * @brief Asettaa näkyvän aikaikkunan pituuden sekunteina.
+     */
+    void setWindowSeconds(int seconds);
+    int windowSeconds() const;
+
+public slots:
+    void addSamples(const QList<SensorSample> &samples);
+    void clear();
+
+private slots:
+    void redraw();
+    void onChannelChanged();
+
+private:
+    static constexpr int RedrawIntervalMs = 33; ///< Noin 30 kuvaa sekunnissa.
+    static constexpr int MaxWindowSeconds = 600;
+
+    SensorType selectedType() const;
+
+    std::array<std::unique_ptr<LiveChannelBuffer>, 256> m_buffers;
+    QComboBox *m_channelBox;
+    QSpinBox *m_windowBox;
+    QChartView *m_view;
+    QChart *m_chart;
+    QLineSeries *m_series;
+    QDateTimeAxis *m_axisX;
+    QValueAxis *m_axisY;
+    QTimer *m_redrawTimer;
+    bool m_dirty = false;
+};
+
+#endif // LIVECHARTWIDGET_H
@@ -0,0 +1,195 @@
+#include "lodpyramid.h"
+
+#include <algorithm>
+
+void LodPyramid::build(const ChannelData &data)
+{
+    clear();
+    const QVector<double> &values = data.values();
+    const qsizetype count = data.size();
+
+    // Taso 0 lasketaan suoraan näytteistä
+    QVector<quint32> minLevel;
+    QVector<quint32> maxLevel;
+    const qsizetype leaves = (count + LeafSize - 1) / LeafSize;
+    minLevel.reserve(leaves);
+    maxLevel.reserve(leaves);
+    for (qsizetype begin = 0; begin < count; begin += LeafSize) {
+        qsizetype minIndex = -1;
+        qsizetype maxIndex = -1;
+        scan(data, begin, qMin(begin + LeafSize, count), minIndex, maxIndex);
+        minLevel.append(quint32(minIndex));
+        maxLevel.append(quint32(maxIndex));
+    }
+
+    // Ylemmät tasot yhdistävät solmuparit, kunnes jäljellä on yksi solmu
+    while (minLevel.size() > 1) {
+        QVector<quint32> nextMin;
+        QVector<quint32> nextMax;
+        nextMin.reserve((minLevel.size() + 1) / 2);
+        nextMax.reserve((minLevel.size() + 1) / 2);
+        for (qsizetype i = 0; i < minLevel.size(); i += 2) {
+            quint32 minIndex = minLevel[i];
+            quint32 maxIndex = maxLevel[i];
+            if (i + 1 < minLevel.size()) {
+                if (values[minLevel[i + 1]] < values[minIndex]) {
+                    minIndex = minLevel[i + 1];
+                }
+                if (values[maxLevel[i + 1]] > values[maxIndex]) {
+                    maxIndex = maxLevel[i + 1];
+                }
+            }
+            nextMin.append(minIndex);
+            nextMax.append(maxIndex);
+        }
+        m_minLevels.append(std::move(minLevel));
+        m_maxLevels.append(std::move(maxLevel));
+        minLevel = std::move(nextMin);
+        maxLevel = std::move(nextMax);
+    }
+    m_minLevels.append(std::move(minLevel));
+    m_maxLevels.append(std::move(maxLevel));
+
+    m_sampleCount = count;
+    m_built = true;
+}
+
+void LodPyramid::assign(qsizetype sampleCount, QList<QVector<quint32>> minLevels, QList<QVector<quint32>> maxLevels)
+{
+    m_minLevels = std::move(minLevels);
+    m_maxLevels = std::move(maxLevels);
+    m_sampleCount = sampleCount;
+    m_built = true;
+}
+
+void LodPyramid::clear()
+{
+    m_built = false;
+    m_sampleCount = 0;
+    m_minLevels.clear();
+    m_maxLevels.clear();
+}
+
+void LodPyramid::consider(const ChannelData &data, qsizetype index, qsizetype &minIndex, qsizetype &maxIndex)
+{
+    const QVector<double> &values = data.values();
+    if (minIndex < 0 || values[index] < values[minIndex]) {
+        minIndex = index;
+    }
+    if (maxIndex < 0 || values[index] > values[maxIndex]) {
+        maxIndex = index;
+    }
+}
+
+void LodPyramid::scan(const ChannelData &data, qsizetype begin, qsizetype end,
+                      qsizetype &minIndex, qsizetype &maxIndex) const
+{
+    for (qsizetype i = begin; i < end; ++i) {
+        consider(data, i, minIndex, maxIndex);
+    }
+}
+
+void LodPyramid::range(const ChannelData &data, qsizetype begin, qsizetype end,
+                       qsizetype &minIndex, qsizetype &maxIndex) const
+{
+    minIndex = -1;
+    maxIndex = -1;
+
+    // Osittaiset lohkot reunoilla käydään läpi suoraan
+    qsizetype firstLeaf = (begin + LeafSize - 1) / LeafSize;
+    qsizetype lastLeaf = end / LeafSize;
+    if (firstLeaf >= lastLeaf) {
+        scan(data, begin, end, minIndex, maxIndex);
+        return;
+    }
+    scan(data, begin, firstLeaf * LeafSize, minIndex, maxIndex);
+    scan(data, lastLeaf * LeafSize, end, minIndex, maxIndex);
+
+    // Kokonaiset lohkot [firstLeaf, lastLeaf) puretaan pyramidin solmuiksi
+    const QVector<double> &values = data.values();
+    for (int level = 0; firstLeaf < lastLeaf; ++level) {
+        const QVector<quint32> &minLevel = m_minLevels[level];
+        const QVector<quint32> &maxLevel = m_maxLevels[level];
+        const auto take = [&](qsizetype node) {
+            if (minIndex < 0 || values[minLevel[node]] < values[minIndex]) {
+                minIndex = minLevel[node];
+            }
+            if (maxIndex < 0 || values[maxLevel[node]] > values[maxIndex]) {
+                maxIndex = maxLevel[node];
+            }
+        };
+        if (firstLeaf & 1) {
+            take(firstLeaf++);
+        }
+        if (lastLeaf & 1) {
+            take(--lastLeaf);
+        }
+        firstLeaf >>= 1;
+        lastLeaf >>= 1;
+    }
+}
+
+QList<QPointF> LodPyramid::decimate(const ChannelData &data, qint64 fromMs, qint64 toMs, int pixelWidth) const
+{
+    QList<QPointF> points;
+    const QVector<qint64> &timestamps = data.timestamps();
+    const QVector<double> &values = data.values();
+    if (data.isEmpty() || toMs < fromMs) {
+        return points;
+    }
+
+    const auto point = [&](qsizetype index) {
+        return QPointF(timestamps[index], values[index]);
+    };
+
+    const qsizetype first = std::lower_bound(timestamps.cbegin(), timestamps.cend(), fromMs) - timestamps.cbegin();
+    const qsizetype end = std::upper_bound(timestamps.cbegin() + first, timestamps.cend(), toMs) - timestamps.cbegin();
+    const qsizetype before = qMax<qsizetype>(first - 1, 0);
+    const qsizetype after = qMin(end + 1, data.size());
+
+    // Harvalla datalla piirretään näytteet sellaisenaan
+    pixelWidth = qMax(pixelWidth, 1);
+    if (after - before <= 4 * qsizetype(pixelWidth)) {
+        points.reserve(after - before);
+        for (qsizetype i = before; i < after; ++i) {
+            points.append(point(i));
+        }
+        return points;
+    }
+
+    points.reserve(4 * pixelWidth + 2);
+    if (before < first) {
+        points.append(point(before));
+    }
+
+    const qint64 span = toMs - fromMs + 1;
+    qsizetype bucketBegin = first;
+    for (int column = 0; column < pixelWidth && bucketBegin < end; ++column) {
+        const qint64 bucketEndMs = fromMs + span * (column + 1) / pixelWidth; // Ei sisälly sarakkeeseen
+        const qsizetype bucketEnd = std::lower_bound(timestamps.cbegin() + bucketBegin, timestamps.cbegin() + end,
+                                                     bucketEndMs) - timestamps.cbegin();
+        if (bucketEnd == bucketBegin) {
+            continue;
+        }
+
+        qsizetype minIndex;
+        qsizetype maxIndex;
+        range(data, bucketBegin, bucketEnd, minIndex, maxIndex);
+
+        // Ensimmäinen, min ja max aikajärjestyksessä, viimeinen; samat indeksit vain kerran
+        qsizetype indices[4] = { bucketBegin, qMin(minIndex, maxIndex), qMax(minIndex, maxIndex), bucketEnd - 1 };
+        qsizetype previous = -1;
+        for (qsizetype index : indices) {
+            if (index != previous) {
+                points.append(point(index));
+                previous = index;
+            }
+        }
+        bucketBegin = bucketEnd;
+    }
+
+    if (end < after) {
+        points.append(point(end));
+    }
+    return points;
+}
@@ -0,0 +1,70 @@
+#ifndef LODPYRAMID_H
+#define LODPYRAMID_H
+
+#include <QList>
+#include <QPointF>
+#include <QVector>
+#include "channeldata.h"
+
+/**
+ * @class LodPyramid
+ * @brief Min/max-pyramidi kanavan piirtämiseen näytön leveyden tarkkuudella.
+ *
+ * Taso 0 sisältää LeafSize näytteen lohkojen minimi- ja maksimi-indeksit,
+ * ja jokainen seuraava taso yhdistää kaksi edellisen tason solmua. Minkä
+ * tahansa indeksivälin minimi ja maksimi saadaan näin O(log n) ajassa.
+ *
+ * decimate() jakaa näkyvän aikavälin pikselisarakkeisiin ja palauttaa
+ * jokaisesta sarakkeesta ensimmäisen, pienimmän, suurimman ja viimeisen
+ * näytteen (M4). Viivakaavio näyttää tällöin pikselilleen samalta kuin
+ * kaikista näytteistä piirretty, mutta pisteitä on enintään neljä
+ * pikseliä kohden.
+ */
+class LodPyramid
+{
+public:
+    void build(const ChannelData &data);
+    void clear();
+
+    /**
+     * @brief Ottaa käyttöön valmiiksi lasketut tasot (esim. LogCache), alin taso ensin.
+     */
+    void assign(qsizetype sampleCount, QList<QVector<quint32>> minLevels, QList<QVector<quint32>> maxLevels);
+
+    int levelCount() const { return int(m_minLevels.size()); }
+    const QVector<quint32> &minLevel(int level) const { return m_minLevels[level]; }
+    const QVector<quint32> &maxLevel(int level) const { return m_maxLevels[level]; }
+
+    /**
+     * @brief true, jos pyramidi on rakennettu @p data:n nykyiselle näytemäärälle.
+     */
+    bool isBuiltFor(const ChannelData &data) const { return m_built && m_sampleCount == data.size(); }
+
+    /**
+     * @brief Pienimmän ja suurimman arvon indeksit välillä [begin, end). Väli ei saa olla tyhjä.
+     */
+    void range(const ChannelData &data, qsizetype begin, qsizetype end,
+               qsizetype &minIndex, qsizetype &maxIndex) const;
+
+    /**
+     * @brief Piirrettävät pisteet aikavälille [fromMs, toMs] @p pixelWidth pikselin levyisenä.
+     *
+     * Mukana on myös välin ulkopuolinen naapurinäyte kummallakin puolella,
+     * jotta viiva jatkuu piirtoalueen reunaan asti.
+     */
+    QList<QPointF> decimate(const ChannelData &data, qint64 fromMs, qint64 toMs, int pixelWidth) const;
+
+    static constexpr qsizetype LeafSize = 16; ///< Näytettä tason 0 solmua kohden.
+
+private:
+    void scan(const ChannelData &data, qsizetype begin, qsizetype end,
+              qsizetype &minIndex, qsizetype &maxIndex) const;
+    static void consider(const ChannelData &data, qsizetype index, qsizetype &minIndex, qsizetype &maxIndex);
+
+    bool m_built = false;
+    qsizetype m_sampleCount = 0;
+    QList<QVector<quint32>> m_minLevels; // Taso -> solmujen minimi-indeksit
+    QList<QVector<quint32>> m_maxLevels;
+};
+
+#endif // LODPYRAMID_H
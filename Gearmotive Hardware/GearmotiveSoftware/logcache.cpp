@@ -0,0 +1,376 @@
+#include "logcache.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QObject>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include "binarylogformat.h"
+#include "csvlogreader.h"
+
+// Taulukot käytetään suoraan muistiin kuvatusta tiedostosta
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "LogCache requires a little-endian host");
+
+namespace {
+
+constexpr char Magic[4] = { 'G', 'M', 'L', 'C' };
+constexpr quint16 Version = 1;
+constexpr qint64 HeaderSize = 24;
+constexpr qint64 TrailerSize = 12;
+
+qint64 align8(qint64 offset)
+{
+    return (offset + 7) & ~qint64(7);
+}
+
+void appendString(QByteArray &out, const QString &text)
+{
+    const QByteArray utf8 = text.toUtf8().left(0xFFFF);
+    BinaryLog::appendValue<quint16>(out, quint16(utf8.size()));
+    out.append(utf8);
+}
+
+// Rajattu lukija hakemistolle; virheellinen tiedosto ei voi lukea ohi alueen
+struct Cursor {
+    const uchar *pos;
+    const uchar *end;
+    bool ok = true;
+
+    template <typename T>
+    T read()
+    {
+        if (!ok || end - pos < qsizetype(sizeof(T))) {
+            ok = false;
+            return T();
+        }
+        const T value = qFromLittleEndian<T>(pos);
+        pos += sizeof(T);
+        return value;
+    }
+
+    QString readString()
+    {
+        const quint16 size = read<quint16>();
+        if (!ok || end - pos < size) {
+            ok = false;
+            return QString();
+        }
+        const QString text = QString::fromUtf8(reinterpret_cast<const char *>(pos), size);
+        pos += size;
+        return text;
+    }
+};
+
+} // namespace
+
+QString LogCache::cachePath(const QString &logPath)
+{
+    return logPath + QStringLiteral(".gmcache");
+}
+
+bool LogCache::build(const QString &logPath, const std::atomic_bool &stop, QString *error)
+{
+    const auto fail = [error](const QString &message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    // Koko ja muokkausaika luetaan ennen jäsennystä: jos loki muuttuu sen
+    // aikana, välimuisti ei vastaa sitä eikä sitä käytetä
+    const QFileInfo info(logPath);
+    const qint64 sourceSize = info.size();
+    const qint64 sourceModifiedMs = info.lastModified().toMSecsSinceEpoch();
+
+    CsvLogReader reader;
+    if (!reader.open(logPath)) {
+        return fail(reader.errorString());
+    }
+
+    // Näytemäärät indeksistä, jotta jokaiselle kanavalle varataan yhtenäinen
+    // alue ennen jäsennystä. Jäsennys hylkää vähintään samat rivit kuin
+    // indeksointi, joten varaus riittää aina.
+    QList<QByteArray> keys;
+    QList<Channel> channels;
+    QList<quint64> capacities;
+    for (int i = 0; i < reader.chunkCount(); ++i) {
+        if (stop) {
+            return false;
+        }
+        for (const CsvLogReader::ChunkSummary &summary : reader.indexChunk(i)) {
+            qsizetype k = keys.indexOf(summary.name);
+            if (k < 0) {
+                keys.append(summary.name);
+                Channel channel;
+                channel.name = QString::fromUtf8(summary.name);
+                channel.unit = QString::fromUtf8(summary.unit);
+                channels.append(channel);
+                capacities.append(0);
+                k = keys.size() - 1;
+            }
+            capacities[k] += summary.count;
+        }
+    }
+
+    qint64 dataEnd = HeaderSize;
+    for (qsizetype k = 0; k < channels.size(); ++k) {
+        channels[k].timestampsOffset = dataEnd;
+        dataEnd += qint64(capacities[k] * sizeof(qint64));
+        channels[k].valuesOffset = dataEnd;
+        dataEnd += qint64(capacities[k] * sizeof(double));
+    }
+
+    // Kirjoitetaan väliaikaiseen tiedostoon, joka kuvataan muistiin sekä
+    // kirjoitusta että pyramidien laskentaa varten, ja nimetään lopuksi
+    const QString finalPath = cachePath(logPath);
+    const QString tempPath = finalPath + QStringLiteral(".tmp");
+    QFile file(tempPath);
+    const auto abort = [&file](const QString &message) {
+        file.close();
+        file.remove();
+        return message;
+    };
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+        return fail(file.errorString());
+    }
+    if (!file.resize(dataEnd)) {
+        return fail(abort(file.errorString()));
+    }
+    uchar *out = file.map(0, dataEnd);
+    if (!out) {
+        return fail(abort(file.errorString()));
+    }
+
+    std::memcpy(out, Magic, sizeof(Magic));
+    qToLittleEndian<quint16>(Version, out + 4);
+    qToLittleEndian<quint16>(0, out + 6);
+    qToLittleEndian<qint64>(sourceSize, out + 8);
+    qToLittleEndian<qint64>(sourceModifiedMs, out + 16);
+
+    for (int i = 0; i < reader.chunkCount(); ++i) {
+        if (stop) {
+            return fail(abort(QString()));
+        }
+        for (const CsvLogReader::ChunkChannel &part : reader.parseChunk(i)) {
+            const qsizetype k = keys.indexOf(part.name);
+            if (k < 0) {
+                continue;
+            }
+            Channel &channel = channels[k];
+            const quint64 n = qMin(quint64(part.timestamps.size()), capacities[k] - channel.count);
+            std::memcpy(out + channel.timestampsOffset + channel.count * sizeof(qint64),
+                        part.timestamps.constData(), n * sizeof(qint64));
+            std::memcpy(out + channel.valuesOffset + channel.count * sizeof(double),
+                        part.values.constData(), n * sizeof(double));
+            channel.count += n;
+        }
+    }
+    reader.close();
+
+    // Pyramidit lasketaan suoraan kuvatusta datasta ja kirjoitetaan sen perään
+    qint64 pos = dataEnd;
+    for (Channel &channel : channels) {
+        if (stop) {
+            return fail(abort(QString()));
+        }
+        if (channel.count == 0) {
+            continue;
+        }
+        const qint64 *timestamps = reinterpret_cast<const qint64 *>(out + channel.timestampsOffset);
+        const double *values = reinterpret_cast<const double *>(out + channel.valuesOffset);
+        const qsizetype count = qsizetype(channel.count);
+        if (!std::is_sorted(timestamps, timestamps + count)) {
+            // Pyramidi lasketaan vasta järjestetystä datasta avattaessa
+            const auto [first, last] = std::minmax_element(timestamps, timestamps + count);
+            channel.firstMs = *first;
+            channel.lastMs = *last;
+            continue;
+        }
+        channel.firstMs = timestamps[0];
+        channel.lastMs = timestamps[count - 1];
+
+        ChannelData data;
+        data.assign(QVector<qint64>::fromRawData(timestamps, count), QVector<double>::fromRawData(values, count));
+        LodPyramid lod;
+        lod.build(data);
+        for (int level = 0; level < lod.levelCount(); ++level) {
+            Level entry;
+            entry.count = quint64(lod.minLevel(level).size());
+            const qint64 bytes = qint64(entry.count * sizeof(quint32));
+            entry.minOffset = align8(pos);
+            entry.maxOffset = align8(entry.minOffset + bytes);
+            if (!file.seek(entry.minOffset)
+                || file.write(reinterpret_cast<const char *>(lod.minLevel(level).constData()), bytes) != bytes
+                || !file.seek(entry.maxOffset)
+                || file.write(reinterpret_cast<const char *>(lod.maxLevel(level).constData()), bytes) != bytes) {
+                return fail(abort(file.errorString()));
+            }
+            pos = entry.maxOffset + bytes;
+            channel.levels.append(entry);
+        }
+    }
+    file.unmap(out);
+
+    QByteArray directory;
+    BinaryLog::appendValue<quint32>(directory, quint32(channels.size()));
+    for (const Channel &channel : std::as_const(channels)) {
+        appendString(directory, channel.name);
+        appendString(directory, channel.unit);
+        BinaryLog::appendValue<quint64>(directory, channel.count);
+        BinaryLog::appendValue<qint64>(directory, channel.firstMs);
+        BinaryLog::appendValue<qint64>(directory, channel.lastMs);
+        BinaryLog::appendValue<qint64>(directory, channel.timestampsOffset);
+        BinaryLog::appendValue<qint64>(directory, channel.valuesOffset);
+        BinaryLog::appendValue<quint32>(directory, quint32(channel.levels.size()));
+        for (const Level &level : channel.levels) {
+            BinaryLog::appendValue<quint64>(directory, level.count);
+            BinaryLog::appendValue<qint64>(directory, level.minOffset);
+            BinaryLog::appendValue<qint64>(directory, level.maxOffset);
+        }
+    }
+    BinaryLog::appendValue<qint64>(directory, pos);
+    directory.append(Magic, sizeof(Magic));
+
+    if (!file.seek(pos) || file.write(directory) != directory.size() || !file.flush()) {
+        return fail(abort(file.errorString()));
+    }
+    file.close();
+
+    QFile::remove(finalPath);
+    if (!QFile::rename(tempPath, finalPath)) {
+        QFile::remove(tempPath);
+        return fail(QObject::tr("Välimuistin tallentaminen epäonnistui."));
+    }
+    return true;
+}
+
+bool LogCache::open(const QString &logPath)
+{
+    close();
+    const QFileInfo info(logPath);
+    if (!info.exists()) {
+        return false;
+    }
+
+    m_file.setFileName(cachePath(logPath));
+    if (!m_file.exists() || !m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    m_size = m_file.size();
+    if (m_size >= HeaderSize + TrailerSize) {
+        m_data = m_file.map(0, m_size);
+    }
+    if (!m_data || !parseDirectory(info.size(), info.lastModified().toMSecsSinceEpoch())) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void LogCache::close()
+{
+    // Muistiin kuvaus puretaan tiedoston sulkemisen yhteydessä
+    m_file.close();
+    m_data = nullptr;
+    m_size = 0;
+    m_channels.clear();
+}
+
+bool LogCache::parseDirectory(qint64 sourceSize, qint64 sourceModifiedMs)
+{
+    if (std::memcmp(m_data, Magic, sizeof(Magic)) != 0
+        || qFromLittleEndian<quint16>(m_data + 4) != Version
+        || qFromLittleEndian<qint64>(m_data + 8) != sourceSize
+        || qFromLittleEndian<qint64>(m_data + 16) != sourceModifiedMs
+        || std::memcmp(m_data + m_size - sizeof(Magic), Magic, sizeof(Magic)) != 0) {
+        return false;
+    }
+
+    const qint64 directoryOffset = qFromLittleEndian<qint64>(m_data + m_size - TrailerSize);
+    if (directoryOffset < HeaderSize || directoryOffset > m_size - TrailerSize) {
+        return false;
+    }
+
+    // Taulukoiden on oltava kokonaan datan alueella ja tasattuina
+    const auto inData = [directoryOffset](qint64 offset, quint64 count, qint64 itemSize, qint64 alignment) {
+        return offset >= HeaderSize && offset % alignment == 0 && offset <= directoryOffset
+            && count <= quint64(directoryOffset - offset) / quint64(itemSize);
+    };
+
+    Cursor cursor { m_data + directoryOffset, m_data + m_size - TrailerSize };
+    const quint32 channelCount = cursor.read<quint32>();
+    for (quint32 i = 0; cursor.ok && i < channelCount; ++i) {
+        Channel channel;
+        channel.name = cursor.readString();
+        channel.unit = cursor.readString();
+        channel.count = cursor.read<quint64>();
+        channel.firstMs = cursor.read<qint64>();
+        channel.lastMs = cursor.read<qint64>();
+        channel.timestampsOffset = cursor.read<qint64>();
+        channel.valuesOffset = cursor.read<qint64>();
+        const quint32 levelCount = cursor.read<quint32>();
+        for (quint32 level = 0; cursor.ok && level < levelCount; ++level) {
+            Level entry;
+            entry.count = cursor.read<quint64>();
+            entry.minOffset = cursor.read<qint64>();
+            entry.maxOffset = cursor.read<qint64>();
+            if (!inData(entry.minOffset, entry.count, sizeof(quint32), sizeof(quint32))
+                || !inData(entry.maxOffset, entry.count, sizeof(quint32), sizeof(quint32))) {
+                return false;
+            }
+            channel.levels.append(entry);
+        }
+        if (!cursor.ok || !inData(channel.timestampsOffset, channel.count, sizeof(qint64), sizeof(qint64))
+            || !inData(channel.valuesOffset, channel.count, sizeof(double), sizeof(double))) {
+            return false;
+        }
+        m_channels.append(channel);
+    }
+    return cursor.ok;
+}
+
+void LogCache::samples(int channel, QVector<qint64> &timestamps, QVector<double> &values) const
+{
+    const Channel &info = m_channels[channel];
+    const qsizetype count = qsizetype(info.count);
+    timestamps = QVector<qint64>::fromRawData(reinterpret_cast<const qint64 *>(m_data + info.timestampsOffset), count);
+    values = QVector<double>::fromRawData(reinterpret_cast<const double *>(m_data + info.valuesOffset), count);
+}
+
+bool LogCache::lod(int channel, LodPyramid &lod) const
+{
+    const Channel &info = m_channels[channel];
+    if (info.levels.isEmpty()) {
+        return false;
+    }
+
+    // Rakenne ja indeksit tarkistetaan, ettei vioittunut tiedosto johda
+    // lukemiseen näytetaulukoiden ohi
+    QList<QVector<quint32>> minLevels;
+    QList<QVector<quint32>> maxLevels;
+    for (qsizetype level = 0; level < info.levels.size(); ++level) {
+        const Level &entry = info.levels[level];
+        const quint64 expected = level == 0 ? (info.count + LodPyramid::LeafSize - 1) / LodPyramid::LeafSize
+                                            : (info.levels[level - 1].count + 1) / 2;
+        if (entry.count != expected) {
+            return false;
+        }
+        const quint32 *mins = reinterpret_cast<const quint32 *>(m_data + entry.minOffset);
+        const quint32 *maxs = reinterpret_cast<const quint32 *>(m_data + entry.maxOffset);
+        const qsizetype count = qsizetype(entry.count);
+        const auto outOfRange = [&info](quint32 index) { return index >= info.count; };
+        if (std::any_of(mins, mins + count, outOfRange) || std::any_of(maxs, maxs + count, outOfRange)) {
+            return false;
+        }
+        minLevels.append(QVector<quint32>::fromRawData(mins, count));
+        maxLevels.append(QVector<quint32>::fromRawData(maxs, count));
+    }
+    if (info.levels.last().count != 1) {
+        return false;
+    }
+
+    lod.assign(qsizetype(info.count), std::move(minLevels), std::move(maxLevels));
+    return true;
+}
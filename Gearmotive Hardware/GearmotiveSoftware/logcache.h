@@ -0,0 +1,89 @@
+#ifndef LOGCACHE_H
+#define LOGCACHE_H
+
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include "channeldata.h"
+#include "lodpyramid.h"
+
+/**
+ * @class LogCache
+ * @brief Lokin rinnalle tallennettu välimuisti puretuista kanavista.
+ *
+ * Välimuisti (lokin nimi + ".gmcache") sisältää jokaisen kanavan aikaleimat
+ * ja arvot valmiina taulukoina sekä kanavan min/max-pyramidin tasot. Se on
+ * voimassa, jos lokin koko ja muokkausaika vastaavat tallennettuja. open()
+ * kuvaa tiedoston muistiin, joten kanavan data ja pyramidi saadaan käyttöön
+ * jäsentämättä ja kopioimatta (QVector::fromRawData).
+ *
+ * Muoto (little-endian, taulukot 8 tavun rajalla):
+ * - Otsikko: "GMLC", u16 versio, u16 varattu, i64 lokin koko, i64 lokin muokkausaika (ms)
+ * - Data: kanavittain i64-aikaleimat ja f64-arvot, perässä pyramidien u32-tasot
+ * - Hakemisto: u32 kanavien määrä; jokaiselle nimi ja yksikkö (u16 pituus + UTF-8),
+ *   u64 näytemäärä, i64 ensimmäinen ja viimeinen aika, i64 aikaleimojen ja
+ *   arvojen sijainti, u32 tasojen määrä ja jokaiselle u64 solmumäärä sekä
+ *   i64 minimien ja maksimien sijainti
+ * - Loppu: i64 hakemiston sijainti, "GMLC"
+ */
+class LogCache
+{
+public:
+    struct Level {
+        quint64 count = 0;
+        qint64 minOffset = 0;
+        qint64 maxOffset = 0;
+    };
+
+    struct Channel {
+        QString name;
+        QString unit;
+        quint64 count = 0;
+        qint64 firstMs = 0;
+        qint64 lastMs = 0;
+        qint64 timestampsOffset = 0;
+        qint64 valuesOffset = 0;
+        QList<Level> levels; // Tyhjä, jos näytteet eivät olleet aikajärjestyksessä
+    };
+
+    static QString cachePath(const QString &logPath);
+
+    /**
+     * @brief Jäsentää CSV-lokin kokonaan ja kirjoittaa sen välimuistin.
+     *
+     * Tarkoitettu ajettavaksi taustalla: näytteet kirjoitetaan lohko kerrallaan
+     * suoraan muistiin kuvattuun tiedostoon, joten muistia kuluu vain yhden
+     * lohkon verran. Keskeytyy, kun @p stop asetetaan.
+     */
+    static bool build(const QString &logPath, const std::atomic_bool &stop, QString *error = nullptr);
+
+    /**
+     * @brief Avaa lokin välimuistin. false, jos sitä ei ole tai se ei vastaa lokia.
+     */
+    bool open(const QString &logPath);
+    void close();
+
+    const QList<Channel> &channels() const { return m_channels; }
+
+    /**
+     * @brief Kanavan näytteet suoraan muistiin kuvatusta tiedostosta.
+     */
+    void samples(int channel, QVector<qint64> &timestamps, QVector<double> &values) const;
+
+    /**
+     * @brief Kanavan tallennettu pyramidi. false, jos sitä ei tallennettu.
+     */
+    bool lod(int channel, LodPyramid &lod) const;
+
+private:
+    bool parseDirectory(qint64 sourceSize, qint64 sourceModifiedMs);
+
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    QList<Channel> m_channels;
+};
+
+#endif // LOGCACHE_H
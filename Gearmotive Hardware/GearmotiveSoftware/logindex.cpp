@@ -0,0 +1,234 @@
+#include "logindex.h"
+
+#include <QMutexLocker>
+#include <QObject>
+#include <algorithm>
+
+bool LogIndex::addBinaryFile(const QString &filePath, QString *error, bool *recovered)
+{
+    auto reader = std::make_unique<BinaryLogReader>();
+    if (!reader->open(filePath)) {
+        if (error) {
+            *error = reader->errorString();
+        }
+        return false;
+    }
+    if (recovered) {
+        *recovered = reader->isRecovered();
+    }
+
+    const int file = int(m_files.size());
+    const QList<BinaryLog::ChunkInfo> &chunks = reader->chunks();
+    for (const BinaryLog::ChannelInfo &info : reader->channels()) {
+        Channel &channel = channelFor(info.name, info.unit);
+        for (int i = 0; i < chunks.size(); ++i) {
+            const BinaryLog::ChunkInfo &chunk = chunks[i];
+            if (chunk.type != info.type || chunk.count == 0) {
+                continue;
+            }
+            addRef(channel, { file, i, chunk.firstMs, chunk.lastMs, chunk.count });
+        }
+    }
+
+    m_files.push_back({ nullptr, std::move(reader), nullptr, std::make_unique<QMutex>() });
+    return true;
+}
+
+int LogIndex::addCsvFile(const QString &filePath, QString *error)
+{
+    auto reader = std::make_unique<CsvLogReader>();
+    if (!reader->open(filePath)) {
+        if (error) {
+            *error = reader->errorString();
+        }
+        return -1;
+    }
+    m_files.push_back({ std::move(reader), nullptr, nullptr, nullptr });
+    return int(m_files.size()) - 1;
+}
+
+const CsvLogReader *LogIndex::csvReader(int file) const
+{
+    return file >= 0 && file < int(m_files.size()) ? m_files[size_t(file)].csv.get() : nullptr;
+}
+
+void LogIndex::addCsvSummaries(int file, const QList<QList<CsvLogReader::ChunkSummary>> &summaries)
+{
+    for (int i = 0; i < summaries.size(); ++i) {
+        for (const CsvLogReader::ChunkSummary &summary : summaries[i]) {
+            Channel &channel = channelFor(QString::fromUtf8(summary.name), QString::fromUtf8(summary.unit));
+            addRef(channel, { file, i, summary.firstMs, summary.lastMs, summary.count });
+        }
+    }
+}
+
+bool LogIndex::addCachedFile(const QString &filePath)
+{
+    auto cache = std::make_unique<LogCache>();
+    if (!cache->open(filePath)) {
+        return false;
+    }
+
+    const int file = int(m_files.size());
+    const QList<LogCache::Channel> &channels = cache->channels();
+    for (int i = 0; i < channels.size(); ++i) {
+        const LogCache::Channel &info = channels[i];
+        if (info.count == 0) {
+            continue;
+        }
+        addRef(channelFor(info.name, info.unit), { file, i, info.firstMs, info.lastMs, info.count });
+    }
+
+    m_files.push_back({ nullptr, nullptr, std::move(cache), nullptr });
+    return true;
+}
+
+void LogIndex::clear()
+{
+    m_cache.clear();
+    m_channels.clear();
+    m_files.clear();
+}
+
+LogIndex::Channel &LogIndex::channelFor(const QString &name, const QString &unit)
+{
+    auto it = m_channels.find(name);
+    if (it == m_channels.end()) {
+        Channel channel;
+        channel.name = name;
+        channel.unit = unit;
+        it = m_channels.insert(name, channel);
+    }
+    return it.value();
+}
+
+void LogIndex::addRef(Channel &channel, const ChunkRef &ref)
+{
+    if (channel.chunks.isEmpty()) {
+        channel.firstMs = ref.firstMs;
+        channel.lastMs = ref.lastMs;
+    } else {
+        channel.firstMs = qMin(channel.firstMs, ref.firstMs);
+        channel.lastMs = qMax(channel.lastMs, ref.lastMs);
+    }
+    channel.count += ref.count;
+
+    // Lohkot tulevat yleensä valmiiksi aikajärjestyksessä
+    const auto pos = std::upper_bound(channel.chunks.begin(), channel.chunks.end(), ref.firstMs,
+                                      [](qint64 ms, const ChunkRef &r) { return ms < r.firstMs; });
+    channel.chunks.insert(pos, ref);
+}
+
+LogIndex::Samples LogIndex::decode(const Channel &channel, const ChunkRef &ref) const
+{
+    Samples samples;
+    if (ref.file < 0 || ref.file >= int(m_files.size())) {
+        samples.error = QObject::tr("Tuntematon lokitiedosto.");
+        return samples;
+    }
+
+    const File &file = m_files[size_t(ref.file)];
+    if (file.cache) {
+        // Näytteet viittaavat suoraan muistiin kuvattuun välimuistiin
+        file.cache->samples(ref.chunk, samples.timestamps, samples.values);
+        return samples;
+    }
+    if (file.csv) {
+        // Lohko on jo muistiin kuvattu, joten lukitusta ei tarvita
+        CsvLogReader::Chunk chunk = file.csv->parseChunk(ref.chunk, channel.name.toUtf8());
+        if (!chunk.isEmpty()) {
+            samples.timestamps = std::move(chunk.first().timestamps);
+            samples.values = std::move(chunk.first().values);
+        }
+        return samples;
+    }
+
+    QMutexLocker locker(file.mutex.get());
+    const QList<BinaryLog::ChunkInfo> &chunks = file.binary->chunks();
+    if (ref.chunk < 0 || ref.chunk >= chunks.size()) {
+        samples.error = QObject::tr("Tuntematon lohko.");
+    } else if (!file.binary->readChunk(chunks[ref.chunk], samples.timestamps, samples.values)) {
+        samples.error = file.binary->errorString();
+        samples.timestamps.clear();
+        samples.values.clear();
+    }
+    return samples;
+}
+
+bool LogIndex::cachedLod(const QString &name, LodPyramid &lod) const
+{
+    const auto it = m_channels.constFind(name);
+    if (it == m_channels.cend() || it->chunks.size() != 1) {
+        return false;
+    }
+    const ChunkRef &ref = it->chunks.first();
+    const LogCache *cache = m_files[size_t(ref.file)].cache.get();
+    return cache && cache->lod(ref.chunk, lod);
+}
+
+const ChannelData *LogIndex::cachedChunk(const Channel &channel, const ChunkRef &ref)
+{
+    QList<CachedChunk> &cache = m_cache[channel.name];
+    for (int i = 0; i < cache.size(); ++i) {
+        if (cache[i].file == ref.file && cache[i].chunk == ref.chunk) {
+            if (i > 0) {
+                cache.move(i, 0);
+            }
+            return &cache.first().data;
+        }
+    }
+
+    Samples samples = decode(channel, ref);
+    if (!samples.error.isEmpty()) {
+        return nullptr;
+    }
+    CachedChunk entry { ref.file, ref.chunk, ChannelData() };
+    entry.data.assign(std::move(samples.timestamps), std::move(samples.values));
+    cache.prepend(std::move(entry));
+    while (cache.size() > CachedChunksPerChannel) {
+        cache.removeLast();
+    }
+    return &cache.first().data;
+}
+
+bool LogIndex::nearestSample(const QString &name, qint64 timestampMs, double &value, qint64 *sampleMs)
+{
+    const auto it = m_channels.constFind(name);
+    if (it == m_channels.cend() || it->chunks.isEmpty()) {
+        return false;
+    }
+    const Channel &channel = it.value();
+
+    // Viimeinen lohko, joka alkaa viimeistään haetulla hetkellä, ja sitä
+    // seuraava; lähin näyte on jommassakummassa
+    const auto next = std::upper_bound(channel.chunks.cbegin(), channel.chunks.cend(), timestampMs,
+                                       [](qint64 ms, const ChunkRef &r) { return ms < r.firstMs; });
+    QList<ChunkRef> candidates;
+    if (next != channel.chunks.cbegin()) {
+        candidates.append(*(next - 1));
+    }
+    if (next != channel.chunks.cend()
+        && (candidates.isEmpty() || candidates.first().lastMs < timestampMs)) {
+        candidates.append(*next);
+    }
+
+    bool found = false;
+    qint64 bestDistance = 0;
+    for (const ChunkRef &ref : std::as_const(candidates)) {
+        const ChannelData *data = cachedChunk(channel, ref);
+        const qsizetype index = data ? data->nearestIndex(timestampMs) : -1;
+        if (index < 0) {
+            continue;
+        }
+        const qint64 distance = qAbs(data->timestamps()[index] - timestampMs);
+        if (!found || distance < bestDistance) {
+            found = true;
+            bestDistance = distance;
+            value = data->values()[index];
+            if (sampleMs) {
+                *sampleMs = data->timestamps()[index];
+            }
+        }
+    }
+    return found;
+}
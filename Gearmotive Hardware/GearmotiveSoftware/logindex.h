@@ -0,0 +1,129 @@
+#ifndef LOGINDEX_H
+#define LOGINDEX_H
+
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <memory>
+#include <vector>
+#include "binarylogreader.h"
+#include "channeldata.h"
+#include "csvlogreader.h"
+#include "logcache.h"
+#include "lodpyramid.h"
+
+/**
+ * @class LogIndex
+ * @brief Avattujen lokitiedostojen kanavat ja niiden sijainnit tiedostoissa.
+ *
+ * Tiedostot pidetään auki, ja jokaisesta kanavasta tallennetaan vain lista
+ * lohkoista (tiedosto, lohkon numero, aikaväli, näytemäärä). Binäärilokin
+ * lohkot saadaan suoraan hakemistosta; CSV-lokin lohkot kerätään
+ * CsvLogReader::indexChunk():n tuloksista. Jos CSV-lokilla on voimassa oleva
+ * LogCache, kanava on välimuistissa yhtenä lohkona. Kanavan näytteet
+ * puretaan vasta, kun niitä tarvitaan.
+ *
+ * decode() on säieturvallinen, joten kanavan lohkot voi purkaa rinnakkain.
+ * nearestSample() purkaa vain kohdistimen kohdalla olevan lohkon, ja
+ * muutama viimeksi purettu lohko pidetään muistissa kanavaa kohden.
+ */
+class LogIndex
+{
+public:
+    // Kanavan näytteet yhdessä tiedoston lohkossa
+    struct ChunkRef {
+        int file = 0;
+        int chunk = 0;
+        qint64 firstMs = 0;
+        qint64 lastMs = 0;
+        quint64 count = 0;
+    };
+
+    struct Channel {
+        QString name;
+        QString unit;
+        quint64 count = 0;
+        qint64 firstMs = 0;
+        qint64 lastMs = 0;
+        QList<ChunkRef> chunks; // Alkuajan mukaan järjestettynä
+    };
+
+    // Yhden lohkon purkutulos
+    struct Samples {
+        QVector<qint64> timestamps;
+        QVector<double> values;
+        QString error; // Tyhjä, jos purku onnistui
+    };
+
+    /**
+     * @brief Avaa binäärilokin ja lisää sen kanavat hakemiston perusteella.
+     * @param recovered Asetetaan, jos hakemisto jouduttiin rakentamaan lohkoista.
+     */
+    bool addBinaryFile(const QString &filePath, QString *error, bool *recovered = nullptr);
+
+    /**
+     * @brief Avaa CSV-lokin. Kanavat lisätään vasta addCsvSummaries():lla.
+     * @return Tiedoston numero tai -1 virheen sattuessa.
+     */
+    int addCsvFile(const QString &filePath, QString *error);
+    const CsvLogReader *csvReader(int file) const;
+
+    /**
+     * @brief Lisää CSV-tiedoston kanavat. @p summaries sisältää indexChunk():n tuloksen lohkoittain.
+     */
+    void addCsvSummaries(int file, const QList<QList<CsvLogReader::ChunkSummary>> &summaries);
+
+    /**
+     * @brief Lisää lokin kanavat sen välimuistista. false, jos voimassa olevaa välimuistia ei ole.
+     */
+    bool addCachedFile(const QString &filePath);
+
+    void clear();
+    bool isEmpty() const { return m_channels.isEmpty(); }
+    const QMap<QString, Channel> &channels() const { return m_channels; }
+
+    /**
+     * @brief Purkaa kanavan @p channel näytteet lohkosta @p ref. Säieturvallinen.
+     */
+    Samples decode(const Channel &channel, const ChunkRef &ref) const;
+
+    /**
+     * @brief Välimuistiin tallennettu pyramidi, jos koko kanava on yhdessä välimuistissa.
+     */
+    bool cachedLod(const QString &name, LodPyramid &lod) const;
+
+    /**
+     * @brief Hakee kanavan lähimmän näytteen arvon purkamalla vain tarvittavat lohkot.
+     * @param sampleMs Jos annettu, saa löydetyn näytteen aikaleiman.
+     * @return false, jos kanavaa ei ole tai sen lohkoja ei voitu purkaa.
+     */
+    bool nearestSample(const QString &name, qint64 timestampMs, double &value, qint64 *sampleMs = nullptr);
+
+private:
+    struct File {
+        std::unique_ptr<CsvLogReader> csv;
+        std::unique_ptr<BinaryLogReader> binary;
+        std::unique_ptr<LogCache> cache;
+        std::unique_ptr<QMutex> mutex; // BinaryLogReader lukee saman QFile:n kautta
+    };
+
+    struct CachedChunk {
+        int file;
+        int chunk;
+        ChannelData data;
+    };
+
+    static constexpr int CachedChunksPerChannel = 2;
+
+    Channel &channelFor(const QString &name, const QString &unit);
+    static void addRef(Channel &channel, const ChunkRef &ref);
+    const ChannelData *cachedChunk(const Channel &channel, const ChunkRef &ref);
+
+    std::vector<File> m_files;
+    QMap<QString, Channel> m_channels;
+    QMap<QString, QList<CachedChunk>> m_cache; // Viimeksi käytetty ensin
+};
+
+#endif // LOGINDEX_H
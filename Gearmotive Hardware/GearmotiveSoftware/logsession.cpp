@@ -0,0 +1,178 @@
+#include "logsession.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+namespace {
+
+const int ManifestVersion = 1;
+
+QJsonObject channelToJson(const LogChannelSummary &channel)
+{
+    QJsonObject json;
+    json["type"] = int(channel.type);
+    json["name"] = channel.name;
+    json["unit"] = channel.unit;
+    json["count"] = qint64(channel.count);
+    json["firstMs"] = channel.firstMs;
+    json["lastMs"] = channel.lastMs;
+    json["min"] = channel.minValue;
+    json["max"] = channel.maxValue;
+    return json;
+}
+
+LogChannelSummary channelFromJson(const QJsonObject &json)
+{
+    LogChannelSummary channel;
+    channel.type = quint8(json["type"].toInt());
+    channel.name = json["name"].toString();
+    channel.unit = json["unit"].toString();
+    channel.count = quint64(json["count"].toInteger());
+    channel.firstMs = json["firstMs"].toInteger();
+    channel.lastMs = json["lastMs"].toInteger();
+    channel.minValue = json["min"].toDouble();
+    channel.maxValue = json["max"].toDouble();
+    return channel;
+}
+
+} // namespace
+
+void LogChannelSummary::add(qint64 timestampMs, double value)
+{
+    if (count == 0) {
+        firstMs = timestampMs;
+        minValue = value;
+        maxValue = value;
+    }
+    lastMs = timestampMs;
+    minValue = qMin(minValue, value);
+    maxValue = qMax(maxValue, value);
+    ++count;
+}
+
+quint64 LogSegment::sampleCount() const
+{
+    quint64 total = 0;
+    for (const LogChannelSummary &channel : channels) {
+        total += channel.count;
+    }
+    return total;
+}
+
+QString LogSession::manifestPath(const QString &firstSegmentPath)
+{
+    // Pääte säilyy nimessä, jotta saman nimiset CSV- ja binääri-istunnot
+    // samassa hakemistossa eivät jaa manifestia
+    const QFileInfo info(firstSegmentPath);
+    return info.dir().filePath(info.fileName() + manifestSuffix());
+}
+
+QString LogSession::segmentPath(const QString &firstSegmentPath, int index)
+{
+    if (index <= 1) {
+        return firstSegmentPath;
+    }
+    const QFileInfo info(firstSegmentPath);
+    const QString name = QStringLiteral("%1_%2").arg(info.completeBaseName()).arg(index, 3, 10, QLatin1Char('0'));
+    return info.dir().filePath(info.suffix().isEmpty() ? name : name + '.' + info.suffix());
+}
+
+QString LogSession::unusedSegmentPath(const QString &firstSegmentPath, int index)
+{
+    QString path = segmentPath(firstSegmentPath, index);
+    while (QFileInfo::exists(path)) {
+        path = segmentPath(firstSegmentPath, ++index);
+    }
+    return path;
+}
+
+bool LogSession::isManifest(const QString &filePath)
+{
+    return filePath.endsWith(manifestSuffix(), Qt::CaseInsensitive);
+}
+
+QString LogSession::segmentFilePath(const LogSegment &segment) const
+{
+    return QDir(m_directory).filePath(segment.fileName);
+}
+
+bool LogSession::load(const QString &manifestPath, QString *error)
+{
+    QFile file(manifestPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!document.isObject()) {
+        if (error) {
+            *error = parseError.errorString();
+        }
+        return false;
+    }
+
+    const QJsonObject root = document.object();
+    m_directory = QFileInfo(manifestPath).absolutePath();
+    format = root["format"].toString();
+    startedMs = root["startedMs"].toInteger();
+    segments.clear();
+    for (const QJsonValue &segmentValue : root["segments"].toArray()) {
+        const QJsonObject json = segmentValue.toObject();
+        LogSegment segment;
+        segment.fileName = json["file"].toString();
+        segment.firstMs = json["firstMs"].toInteger();
+        segment.lastMs = json["lastMs"].toInteger();
+        segment.bytes = json["bytes"].toInteger();
+        segment.complete = json["complete"].toBool();
+        for (const QJsonValue &channelValue : json["channels"].toArray()) {
+            segment.channels.append(channelFromJson(channelValue.toObject()));
+        }
+        segments.append(segment);
+    }
+    return true;
+}
+
+bool LogSession::save(const QString &manifestPath, QString *error) const
+{
+    QJsonArray segmentArray;
+    for (const LogSegment &segment : segments) {
+        QJsonArray channelArray;
+        for (const LogChannelSummary &channel : segment.channels) {
+            channelArray.append(channelToJson(channel));
+        }
+        QJsonObject json;
+        json["file"] = segment.fileName;
+        json["firstMs"] = segment.firstMs;
+        json["lastMs"] = segment.lastMs;
+        json["bytes"] = segment.bytes;
+        json["complete"] = segment.complete;
+        json["channels"] = channelArray;
+        segmentArray.append(json);
+    }
+
+    QJsonObject root;
+    root["version"] = ManifestVersion;
+    root["format"] = format;
+    root["startedMs"] = startedMs;
+    root["segments"] = segmentArray;
+
+    // Vaihdetaan valmis tiedosto paikalleen, jotta kaatuminen ei jätä puolikasta manifestia
+    QSaveFile file(manifestPath);
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(QJsonDocument(root).toJson()) < 0
+        || !file.commit()) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,87 @@
+#ifndef LOGSESSION_H
+#define LOGSESSION_H
+
+#include <QList>
+#include <QString>
+#include "sensordata.h"
+
+// Yhden kanavan yhteenveto lokin osassa
+struct LogChannelSummary {
+    quint8 type = 0;
+    QString name;
+    QString unit;
+    quint64 count = 0;
+    qint64 firstMs = 0;
+    qint64 lastMs = 0;
+    double minValue = 0.0;
+    double maxValue = 0.0;
+
+    void add(qint64 timestampMs, double value);
+};
+
+// Yksi lokitiedosto istunnossa
+struct LogSegment {
+    QString fileName;   // Suhteessa manifestin hakemistoon
+    qint64 firstMs = 0;
+    qint64 lastMs = 0;
+    qint64 bytes = 0;
+    bool complete = false; // false: lokitus oli kesken (tai ohjelma kaatui) tämän osan aikana
+    QList<LogChannelSummary> channels;
+
+    quint64 sampleCount() const;
+};
+
+/**
+ * @class LogSession
+ * @brief Lokitusistunnon osat ja niiden manifesti.
+ *
+ * Istunto alkaa käyttäjän valitsemasta tiedostosta (esim. datalog.csv).
+ * Seuraavat osat nimetään datalog_002.csv, datalog_003.csv jne., ja
+ * manifesti datalog.csv.session.json listaa osat aikaväleineen ja
+ * kanavakohtaisine yhteenvetoineen. Manifesti kirjoitetaan atomisesti
+ * aina osan alkaessa ja päättyessä sekä lokituksen aikana muutaman sekunnin
+ * välein, joten kaatumisen jälkeenkin se kuvaa kaikki osat ja keskeneräisen
+ * osan lähes ajantasaisena.
+ *
+ * Jos lokitus aloitetaan uudelleen samaan tiedostoon, istunto jatkuu
+ * uusina osina. Osaksi ei koskaan valita jo olemassa olevaa tiedostoa.
+ */
+class LogSession
+{
+public:
+    static QString manifestSuffix() { return QStringLiteral(".session.json"); }
+
+    /**
+     * @brief Manifestin polku istunnon ensimmäisen tiedoston perusteella.
+     */
+    static QString manifestPath(const QString &firstSegmentPath);
+
+    /**
+     * @brief Osan @p index (1 = ensimmäinen) tiedostopolku.
+     */
+    static QString segmentPath(const QString &firstSegmentPath, int index);
+
+    /**
+     * @brief Ensimmäinen osan polku indeksistä @p index alkaen, jota ei ole vielä olemassa.
+     */
+    static QString unusedSegmentPath(const QString &firstSegmentPath, int index);
+
+    static bool isManifest(const QString &filePath);
+
+    bool load(const QString &manifestPath, QString *error = nullptr);
+    bool save(const QString &manifestPath, QString *error = nullptr) const;
+
+    /**
+     * @brief Osan tiedoston täysi polku manifestin hakemistossa.
+     */
+    QString segmentFilePath(const LogSegment &segment) const;
+
+    QString format;          // "csv" tai "gmlog"
+    qint64 startedMs = 0;
+    QList<LogSegment> segments;
+
+private:
+    QString m_directory;
+};
+
+#endif // LOGSESSION_H
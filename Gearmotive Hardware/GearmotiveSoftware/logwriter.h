@@ -0,0 +1,51 @@
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <QFile>
+#include <QString>
+#include "sensordata.h"
+
+/**
+ * @class LogWriter
+ * @brief Yhden lokitiedostoformaatin kirjoittaja.
+ *
+ * DataLogger kutsuu kaikkia metodeja omasta kirjoitussäikeestään, joten
+ * toteutusten ei tarvitse olla säieturvallisia. write() saa puskuroida
+ * dataa; flush() siirtää sen käyttöjärjestelmälle ja sync() levylle asti.
+ */
+class LogWriter
+{
+public:
+    virtual ~LogWriter() = default;
+
+    virtual bool open(const QString &filePath) = 0;
+    virtual bool write(const SensorSample *samples, int count) = 0;
+    virtual bool flush() = 0;
+    virtual bool sync() = 0;
+
+    /**
+     * @brief Kirjoittaa puskurit ja tiedoston lopun ja sulkee tiedoston.
+     * @return false, jos jokin kirjoitus epäonnistui; tiedosto suljetaan silti.
+     */
+    virtual bool close() = 0;
+
+    virtual QString errorString() const = 0;
+
+    /**
+     * @brief Tiedoston koko, johon on laskettu myös vielä kirjoittamaton puskuri.
+     */
+    virtual qint64 bytesWritten() const = 0;
+
+    /**
+     * @brief Näytteet, joita formaatti ei voinut tallentaa (esim. CSV:stä puuttuva sarake).
+     */
+    virtual quint64 skippedSamples() const { return 0; }
+
+protected:
+    /**
+     * @brief Tyhjentää tiedoston puskurit ja pakottaa datan levylle (fsync).
+     */
+    static bool syncFile(QFile &file);
+};
+
+#endif // LOGWRITER_H
@@ -1,10 +1,24 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "interactivechartview.h"
+#include "csvlogreader.h"
+#include "logcache.h"
+#include "logsession.h"
 #include <QSerialPortInfo>
 #include <QActionGroup>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QProgressDialog>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+#include <QVBoxLayout>
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QInputDialog>
+#include <QLineEdit>
 #include <QStatusBar>
 #include <QMenu>
 #include <QMap>
@@ -16,32 +30,54 @@
 #include <QGraphicsLineItem>
 #include <QPen>
 #include <QSignalBlocker>
+#include <QVarLengthArray>
+#include <algorithm>
+#include <cmath>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
-    , receiver(new DataReceiver(this))
+    , receiver(new DataReceiver)
     , logger(new DataLogger(this))
+    , m_liveChart(nullptr)
     , m_chart(new QChart())
     , m_cursorLine(nullptr)
     , m_cursorTextItem(nullptr)
 {
     ui->setupUi(this);
+    m_derivedChannels.setDefinitions(DerivedChannelEngine::defaultDefinitions());
+
+    m_unloadedValuesTimer.setSingleShot(true);
+    m_unloadedValuesTimer.setInterval(UnloadedValuesDelayMs);
+    connect(&m_unloadedValuesTimer, &QTimer::timeout, this, [this]() { updateValuesPanel(true); });
+
+    // Sarjaportin luku ja jäsennys ajetaan omassa säikeessään
+    receiver->moveToThread(&m_receiverThread);
+    connect(&m_receiverThread, &QThread::finished, receiver, &QObject::deleteLater);
+    m_receiverThread.start();
+
+    // Reaaliaikainen kaavio arvojen alle
+    m_liveChart = new LiveChartWidget(this);
+    ui->verticalLayout->addWidget(m_liveChart, 1);
+
     ui->splitter->setSizes({200, 800});
     this->showMaximized();
     showSerialPortList();
     showBaudRateList();
+    setupLiveStatistics();
+    showStatisticsWindowList();
 
     connect(ui->actionStartLogging, &QAction::triggered, this, &MainWindow::startLogging);
     connect(ui->actionStopLogging, &QAction::triggered, this, &MainWindow::stopLogging);
     connect(ui->actionOpenLogFile, &QAction::triggered, this, &MainWindow::openLogFile);
     connect(ui->openLogFileButton, &QPushButton::clicked, this, &MainWindow::openLogFile);
     connect(ui->timeSlider, &QSlider::valueChanged, this, &MainWindow::onTimeSliderChanged);
-    connect(ui->sensorListWidget, &QListWidget::currentItemChanged, this, &MainWindow::onSensorSelectionChanged);
+    connect(ui->sensorListWidget, &QListWidget::itemSelectionChanged, this, &MainWindow::onSensorSelectionChanged);
 
     connect(ui->chartView, &InteractiveChartView::cursorPositionChanged, this, &MainWindow::onCursorPositionChanged);
 
     connect(ui->chartView, &InteractiveChartView::viewChanged, this, [this](){
+        updateSeriesDetail();
         if (ui->timeSlider->isEnabled()) {
             onTimeSliderChanged(ui->timeSlider->value());
         }
@@ -49,34 +85,44 @@ MainWindow::MainWindow(QWidget *parent)
 
     // Asetetaan status bar
     loggingStatusLabel = new QLabel(this);
+    deviceStatusLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(deviceStatusLabel);
     statusBar()->addPermanentWidget(loggingStatusLabel);
     updateLoggingStatus(false, "");
     ui->actionStopLogging->setEnabled(false); // Aluksi pois päältä
 
-    connect(receiver, &DataReceiver::newDataReceived, this, [this](const SensorData &data){
-        qDebug() << "vastaanotettu: " << data.name << data.value.toString();
-
-        if (data.name == "Öljylämpötila") {
-            ui->OilTemp->setText(data.value.toString() + data.unit);
-        }
-        else if(data.name == "Ilman lämpötila"){
-            ui->AirTemp->setText(data.value.toString() + data.unit);
-        }
-        else if(data.name == "Ensiöakseli"){
-            ui->PrimaryAxleRpm->setText(data.value.toString() + data.unit);
-        }
-        else if(data.name == "Toisioakseli"){
-            ui->SecondaryAxleRpm->setText(data.value.toString() + data.unit);
-        }
-        else if(data.name == "Vaihteiston vääntö"){
-            ui->GearboxTorque->setText(data.value.toString() + data.unit);
+    connect(receiver, &DataReceiver::samplesReceived, this, [this](const QList<SensorSample> &samples){
+        // Liukuviin tunnuslukuihin viedään kaikki näytteet
+        for (const SensorSample &sample : samples) {
+            const auto live = m_liveStatistics.find(sample.type);
+            if (live != m_liveStatistics.end()) {
+                live->statistics.add(sample.timestampMs, sample.value);
+            }
         }
-        else if(data.name == "Jarrun vääntö"){
-            ui->BrakeTorque->setText(data.value.toString() + data.unit);
+
+        // Päivitetään jokaisesta anturista vain erän viimeisin arvo
+        QList<QLabel *> updated;
+        for (auto it = samples.crbegin(); it != samples.crend(); ++it) {
+            QLabel *label = liveValueLabel(it->type);
+            if (!label || updated.contains(label)) {
+                continue;
+            }
+            label->setText(formatSensorValue(*it) + " " + sensorInfo(it->type).unit);
+            updated.append(label);
+
+            const auto live = m_liveStatistics.constFind(it->type);
+            if (live != m_liveStatistics.cend()) {
+                live->label->setText(statisticsText(live->statistics.summary(), sensorInfo(it->type).decimals));
+            }
         }
     });
 
-    connect(receiver, &DataReceiver::newDataReceived, logger, &DataLogger::logData);
+    connect(receiver, &DataReceiver::samplesReceived, m_liveChart, &LiveChartWidget::addSamples);
+
+    // Loggeri vain puskuroi näytteet lukon alla, joten se kutsutaan suoraan
+    // vastaanottajan säikeestä eikä käyttöliittymän tapahtumasilmukan kautta.
+    connect(receiver, &DataReceiver::samplesReceived, logger, &DataLogger::logSamples, Qt::DirectConnection);
+    connect(receiver, &DataReceiver::deviceStatusReceived, this, &MainWindow::updateDeviceStatus);
 
     connect(logger, &DataLogger::loggingStatusChanged, this, &MainWindow::updateLoggingStatus);
     connect(logger, &DataLogger::errorOccurred, this, [this](const QString &err){
@@ -97,6 +143,15 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    // Vastaanottaja tuhotaan omassa säikeessään (deleteLater), kun säie pysähtyy
+    m_receiverThread.quit();
+    m_receiverThread.wait();
+
+    // Keskeneräiset välimuistit jätetään kesken; ne kirjoitetaan seuraavalla avauksella
+    m_cacheStop = true;
+    for (QFuture<void> &build : m_cacheBuilds) {
+        build.waitForFinished();
+    }
     delete ui;
 }
 
@@ -104,49 +159,25 @@ void MainWindow::openLogFile()
 {
     QString filePath = QFileDialog::getOpenFileName(this, tr("Avaa lokitiedosto"),
                                                     QDir::homePath(),
-                                                    tr("CSV-tiedostot (*.csv);;Kaikki tiedostot (*.*)"));
+                                                    tr("Lokitiedostot (*.csv *.gmlog *%1);;CSV-tiedostot (*.csv);;Binäärilokit (*.gmlog);;"
+                                                       "Istunnot (*%1);;Kaikki tiedostot (*.*)")
+                                                        .arg(LogSession::manifestSuffix()));
 
     if (filePath.isEmpty()) {
         return;
     }
 
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, tr("Virhe"), tr("Tiedoston avaaminen epäonnistui."));
-        return;
+    bool loaded;
+    if (LogSession::isManifest(filePath)) {
+        loaded = loadSession(filePath);
+    } else {
+        clearChartData();
+        loaded = loadLogFile(filePath);
     }
-    
-    clearChartData();
-    
-    QTextStream in(&file);
-    // Ohitetaan otsikkorivi
-    if (!in.atEnd()) {
-        in.readLine();
-    }
-
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        QStringList parts = line.split(',');
-        if (parts.size() == 4) {
-            QDateTime timestamp = QDateTime::fromString(parts[0], Qt::ISODateWithMs);
-            QString name = parts[1];
-            double value = parts[2].toDouble();
-            QString unit = parts[3].trimmed();
-
-            if (!timestamp.isValid()) continue;
-
-            if (m_firstTimestamp.isNull()) m_firstTimestamp = timestamp;
-            m_lastTimestamp = timestamp;
-
-            if (!m_sensorDataMap.contains(name)) {
-                m_sensorDataMap[name].series = new QLineSeries();
-                m_sensorDataMap[name].series->setName(name);
-                m_sensorDataMap[name].unit = unit;
-            }
-            m_sensorDataMap[name].series->append(timestamp.toMSecsSinceEpoch(), value);
-        }
+    if (!loaded) {
+        return;
     }
-    file.close();
+    populateChannels();
 
     if (m_sensorDataMap.isEmpty()) {
         QMessageBox::information(this, tr("Tyhjä"), tr("Lokitiedosto ei sisältänyt dataa."));
@@ -154,6 +185,7 @@ void MainWindow::openLogFile()
     }
     
     ui->sensorListWidget->addItems(m_sensorDataMap.keys());
+    buildValuesPanel();
 
     ui->timeSlider->setRange(0, 1000);
     ui->timeSlider->setValue(0);
@@ -166,14 +198,411 @@ void MainWindow::openLogFile()
     }
 }
 
+bool MainWindow::loadLogFile(const QString &filePath)
+{
+    return filePath.endsWith(QLatin1String(".gmlog"), Qt::CaseInsensitive)
+        ? loadBinaryLog(filePath)
+        : loadCsvLog(filePath);
+}
+
+bool MainWindow::loadSession(const QString &manifestPath)
+{
+    LogSession session;
+    QString error;
+    if (!session.load(manifestPath, &error)) {
+        QMessageBox::warning(this, tr("Virhe"), tr("Istunnon avaaminen epäonnistui: %1").arg(error));
+        return false;
+    }
+    if (session.segments.isEmpty()) {
+        QMessageBox::information(this, tr("Tyhjä"), tr("Istunnossa ei ole lokitiedostoja."));
+        return false;
+    }
+
+    // Käyttäjä valitsee avattavat osat; oletuksena kaikki
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Valitse istunnon osat"));
+    QListWidget *list = new QListWidget(&dialog);
+    list->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    for (const LogSegment &segment : std::as_const(session.segments)) {
+        // Kesken olevan osan yhteenveto päivittyy manifestiin viiveellä, joten
+        // siinä ei välttämättä ole vielä aikaväliä
+        QString text = segment.sampleCount() == 0
+            ? tr("%1   ei yhteenvetoa vielä, %2 kt").arg(segment.fileName).arg(segment.bytes / 1024)
+            : tr("%1   %2 – %3   %4 näytettä, %5 kt")
+                  .arg(segment.fileName,
+                       QDateTime::fromMSecsSinceEpoch(segment.firstMs).toString("dd.MM.yyyy HH:mm:ss"),
+                       QDateTime::fromMSecsSinceEpoch(segment.lastMs).toString("HH:mm:ss"))
+                  .arg(segment.sampleCount())
+                  .arg(segment.bytes / 1024);
+        if (!segment.complete) {
+            text += tr("   (kesken)");
+        }
+        list->addItem(text);
+    }
+    list->selectAll();
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    QVBoxLayout *layout = new QVBoxLayout(&dialog);
+    layout->addWidget(list);
+    layout->addWidget(buttons);
+    dialog.resize(560, 320);
+
+    if (dialog.exec() != QDialog::Accepted) {
+        return false;
+    }
+
+    clearChartData();
+    QStringList missing;
+    for (int row = 0; row < list->count(); ++row) {
+        if (!list->item(row)->isSelected()) {
+            continue;
+        }
+        const QString path = session.segmentFilePath(session.segments[row]);
+        if (!QFileInfo::exists(path)) {
+            missing.append(session.segments[row].fileName);
+            continue;
+        }
+        if (!loadLogFile(path)) {
+            break; // Peruttu tai osa ei auennut; jo ladatut osat jäävät näkyviin
+        }
+    }
+    if (!missing.isEmpty()) {
+        QMessageBox::warning(this, tr("Virhe"), tr("Osia ei löytynyt: %1").arg(missing.join(", ")));
+    }
+    return true;
+}
+
+bool MainWindow::loadCsvLog(const QString &filePath)
+{
+    // Aiemmin avatun lokin kanavat saadaan suoraan välimuistista
+    if (m_logIndex.addCachedFile(filePath)) {
+        return true;
+    }
+
+    QString error;
+    const int file = m_logIndex.addCsvFile(filePath, &error);
+    if (file < 0) {
+        QMessageBox::warning(this, tr("Virhe"), tr("Tiedoston avaaminen epäonnistui: %1").arg(error));
+        return false;
+    }
+
+    const CsvLogReader *reader = m_logIndex.csvReader(file);
+    QList<int> indices;
+    for (int i = 0; i < reader->chunkCount(); ++i) {
+        indices.append(i);
+    }
+    if (indices.isEmpty()) {
+        return true; // Pelkkä otsikko
+    }
+
+    // Ensimmäinen kierros kirjaa vain kanavien lohkot ja aikavälit; arvot
+    // jäsennetään vasta, kun kanavaa tarvitaan
+    QFutureWatcher<QList<CsvLogReader::ChunkSummary>> watcher;
+    watcher.setFuture(QtConcurrent::mapped(indices, [reader](int index) {
+        return reader->indexChunk(index);
+    }));
+    if (!waitWithProgress(watcher, tr("Ladataan %1...").arg(QFileInfo(filePath).fileName()), int(indices.size()))) {
+        statusBar()->showMessage(tr("Lokin lataus peruttiin."), 5000);
+        return false;
+    }
+
+    m_logIndex.addCsvSummaries(file, watcher.future().results());
+    startCacheBuild(filePath);
+    return true;
+}
+
+void MainWindow::startCacheBuild(const QString &filePath)
+{
+    // Välimuisti kirjoitetaan taustalla seuraavia avauksia varten; samaa
+    // lokia ei kirjoiteta kahdesti yhtä aikaa
+    for (auto it = m_cacheBuilds.begin(); it != m_cacheBuilds.end();) {
+        it = it->isFinished() ? m_cacheBuilds.erase(it) : std::next(it);
+    }
+    if (m_cacheBuilds.contains(filePath)) {
+        return;
+    }
+
+    const std::atomic_bool *stop = &m_cacheStop;
+    m_cacheBuilds.insert(filePath, QtConcurrent::run([filePath, stop]() {
+        QString error;
+        if (!LogCache::build(filePath, *stop, &error) && !error.isEmpty()) {
+            qWarning() << "Could not write log cache:" << error;
+        }
+    }));
+}
+
+bool MainWindow::loadBinaryLog(const QString &filePath)
+{
+    // Kanavat ja lohkot saadaan tiedoston lopun hakemistosta
+    QString error;
+    bool recovered = false;
+    if (!m_logIndex.addBinaryFile(filePath, &error, &recovered)) {
+        QMessageBox::warning(this, tr("Virhe"), tr("Tiedoston avaaminen epäonnistui: %1").arg(error));
+        return false;
+    }
+
+    if (recovered) {
+        statusBar()->showMessage(tr("Lokin hakemisto puuttui; data palautettiin ehjistä lohkoista."), 10000);
+    }
+    return true;
+}
+
+bool MainWindow::waitWithProgress(QFutureWatcherBase &watcher, const QString &label, int maximum)
+{
+    // Modaalinen edistymisikkuna pitää käyttöliittymän vasteellisena ja sallii peruutuksen
+    QProgressDialog progress(label, tr("Peruuta"), 0, maximum, this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+
+    QEventLoop loop;
+    connect(&watcher, &QFutureWatcherBase::progressValueChanged, &progress, &QProgressDialog::setValue);
+    connect(&watcher, &QFutureWatcherBase::finished, &loop, &QEventLoop::quit);
+    connect(&progress, &QProgressDialog::canceled, &watcher, &QFutureWatcherBase::cancel);
+    if (!watcher.isFinished()) {
+        loop.exec();
+    }
+    watcher.waitForFinished();
+    return !watcher.isCanceled();
+}
+
+void MainWindow::populateChannels()
+{
+    // Kanavat ja koko lokin aikaväli saadaan indeksistä. Sarjan pisteet
+    // lasketaan vasta piirrettäessä (updateSeriesDetail).
+    for (const LogIndex::Channel &channel : m_logIndex.channels()) {
+        if (channel.count == 0) {
+            continue;
+        }
+
+        SensorChartData &chartData = m_sensorDataMap[channel.name];
+        if (!chartData.series) {
+            chartData.series = new QLineSeries();
+            chartData.series->setName(channel.name);
+            chartData.unit = channel.unit;
+            const QList<SensorType> registered = registeredSensors();
+            const auto known = std::find_if(registered.cbegin(), registered.cend(), [&channel](SensorType type) {
+                return sensorInfo(type).name == channel.name;
+            });
+            if (known != registered.cend()) {
+                chartData.decimals = sensorInfo(*known).decimals;
+            }
+        }
+
+        if (m_firstTimestamp.isNull() || channel.firstMs < m_firstTimestamp.toMSecsSinceEpoch()) {
+            m_firstTimestamp = QDateTime::fromMSecsSinceEpoch(channel.firstMs);
+        }
+        if (m_lastTimestamp.isNull() || channel.lastMs > m_lastTimestamp.toMSecsSinceEpoch()) {
+            m_lastTimestamp = QDateTime::fromMSecsSinceEpoch(channel.lastMs);
+        }
+    }
+
+    // Laskennalliset kanavat lisätään, jos lokissa on niiden syötteet mutta
+    // ei kanavaa itseään (esim. ennen kanavien käyttöönottoa tallennetut lokit)
+    for (const DerivedChannelEngine::Channel &channel : m_derivedChannels.channels()) {
+        const SensorInfo &info = sensorInfo(channel.type);
+        if (m_sensorDataMap.contains(info.name)) {
+            continue;
+        }
+        const QList<SensorType> &inputs = channel.expression.inputs();
+        const bool available = std::all_of(inputs.cbegin(), inputs.cend(), [this](SensorType input) {
+            return m_sensorDataMap.contains(sensorInfo(input).name);
+        });
+        if (!available) {
+            continue;
+        }
+
+        SensorChartData &chartData = m_sensorDataMap[info.name];
+        chartData.series = new QLineSeries();
+        chartData.series->setName(info.name);
+        chartData.unit = info.unit;
+        chartData.decimals = info.decimals;
+        chartData.derived = &channel;
+    }
+}
+
+bool MainWindow::ensureChannelLoaded(const QString &name, const QStringList &keep)
+{
+    auto it = m_sensorDataMap.find(name);
+    if (it == m_sensorDataMap.end()) {
+        return false;
+    }
+    SensorChartData &chartData = it.value();
+    chartData.lastUsed = ++m_useCounter;
+    if (chartData.loaded) {
+        return true;
+    }
+
+    if (chartData.derived) {
+        // Syötteet puretaan ensin, ja kanava lasketaan niistä sarakkeittain
+        QStringList inputNames;
+        for (SensorType input : chartData.derived->expression.inputs()) {
+            inputNames.append(sensorInfo(input).name);
+        }
+        const QStringList loading = QStringList(keep) << name << inputNames;
+        QList<const ChannelData *> inputs;
+        for (const QString &input : std::as_const(inputNames)) {
+            if (!ensureChannelLoaded(input, loading)) {
+                return false;
+            }
+            inputs.append(&m_sensorDataMap[input].data);
+        }
+        chartData.data = DerivedChannelEngine::evaluate(chartData.derived->expression, inputs);
+        chartData.lod.clear();
+        chartData.loaded = true;
+        evictChannels(QStringList(keep) << name);
+        return true;
+    }
+
+    const auto channel = m_logIndex.channels().constFind(name);
+    if (channel == m_logIndex.channels().cend()) {
+        return false;
+    }
+
+    // Kanavan lohkot puretaan rinnakkain; istunnon eri osat jatkavat samaa kanavaa
+    const LogIndex *index = &m_logIndex;
+    const LogIndex::Channel *source = &channel.value();
+    QFutureWatcher<LogIndex::Samples> watcher;
+    watcher.setFuture(QtConcurrent::mapped(source->chunks, [index, source](const LogIndex::ChunkRef &ref) {
+        return index->decode(*source, ref);
+    }));
+    if (!waitWithProgress(watcher, tr("Ladataan kanavaa %1...").arg(name), int(source->chunks.size()))) {
+        statusBar()->showMessage(tr("Kanavan lataus peruttiin."), 5000);
+        return false;
+    }
+
+    // Lohkot yhdistetään ensin, jotta mahdollinen uudelleenjärjestys tehdään
+    // vain kerran. Yksittäinen lohko (esim. välimuistista) otetaan sellaisenaan.
+    QList<LogIndex::Samples> results = watcher.future().results();
+    QVector<qint64> timestamps;
+    QVector<double> values;
+    QString error;
+    if (results.size() == 1 && results.first().error.isEmpty()) {
+        timestamps = std::move(results.first().timestamps);
+        values = std::move(results.first().values);
+    } else {
+        timestamps.reserve(qsizetype(source->count));
+        values.reserve(qsizetype(source->count));
+        for (const LogIndex::Samples &samples : std::as_const(results)) {
+            if (!samples.error.isEmpty()) {
+                error = samples.error;
+                continue;
+            }
+            timestamps.append(samples.timestamps);
+            values.append(samples.values);
+        }
+    }
+    results.clear();
+    if (!error.isEmpty()) {
+        QMessageBox::warning(this, tr("Virhe"), tr("Kanavan %1 lukeminen epäonnistui: %2").arg(name, error));
+    }
+
+    chartData.data.assign(std::move(timestamps), std::move(values));
+    if (!m_logIndex.cachedLod(name, chartData.lod) || !chartData.lod.isBuiltFor(chartData.data)) {
+        chartData.lod.clear();
+    }
+    chartData.loaded = true;
+    evictChannels(QStringList(keep) << name);
+    return true;
+}
+
+void MainWindow::evictChannels(const QStringList &keep)
+{
+    const auto bytes = [](const SensorChartData &data) {
+        return qint64(data.data.size()) * qint64(sizeof(qint64) + sizeof(double));
+    };
+    qint64 total = 0;
+    for (const SensorChartData &data : std::as_const(m_sensorDataMap)) {
+        if (data.loaded) {
+            total += bytes(data);
+        }
+    }
+
+    // Vapautetaan pisimpään käyttämättä olleita kanavia, kunnes puretut
+    // mahtuvat budjettiin. Vapautettu kanava puretaan uudelleen tarvittaessa.
+    while (total > ChannelMemoryBudget) {
+        SensorChartData *oldest = nullptr;
+        for (auto it = m_sensorDataMap.begin(); it != m_sensorDataMap.end(); ++it) {
+            if (it->loaded && !keep.contains(it.key()) && (!oldest || it->lastUsed < oldest->lastUsed)) {
+                oldest = &it.value();
+            }
+        }
+        if (!oldest) {
+            break;
+        }
+        total -= bytes(*oldest);
+        oldest->data = ChannelData();
+        oldest->lod = LodPyramid();
+        oldest->statistics = StatisticsTree();
+        oldest->series->clear();
+        oldest->loaded = false;
+    }
+}
+
+bool MainWindow::nearestValue(const QString &name, qint64 timestampMs, double &value, qint64 *sampleMs)
+{
+    const auto it = m_sensorDataMap.constFind(name);
+    if (it == m_sensorDataMap.cend()) {
+        return false;
+    }
+    const SensorChartData &sensorData = it.value();
+    if (sensorData.loaded) {
+        const qsizetype index = sensorData.data.nearestIndex(timestampMs);
+        if (index < 0) {
+            return false;
+        }
+        value = sensorData.data.values()[index];
+        if (sampleMs) {
+            *sampleMs = sensorData.data.timestamps()[index];
+        }
+        return true;
+    }
+
+    if (sensorData.derived) {
+        // Purkamaton laskennallinen kanava lasketaan syötteiden lähimmistä arvoista.
+        // Kuten DerivedChannelEngine::evaluate():ssa, rivin hetki on uusimman
+        // syötteen aikaleima, eikä muu syöte saa olla MaxInputAgeMs vanhempi.
+        QVarLengthArray<double, 8> inputs;
+        QVarLengthArray<qint64, 8> inputTimes;
+        for (SensorType input : sensorData.derived->expression.inputs()) {
+            double inputValue = 0.0;
+            qint64 inputMs = 0;
+            if (!nearestValue(sensorInfo(input).name, timestampMs, inputValue, &inputMs)) {
+                return false;
+            }
+            inputs.append(inputValue);
+            inputTimes.append(inputMs);
+        }
+        const qint64 rowMs = *std::max_element(inputTimes.cbegin(), inputTimes.cend());
+        for (qint64 inputMs : std::as_const(inputTimes)) {
+            if (rowMs - inputMs > DerivedChannelEngine::MaxInputAgeMs) {
+                return false;
+            }
+        }
+        value = sensorData.derived->expression.evaluate(inputs.constData());
+        if (sampleMs) {
+            *sampleMs = rowMs;
+        }
+        return std::isfinite(value);
+    }
+    return m_logIndex.nearestSample(name, timestampMs, value, sampleMs);
+}
+
 void MainWindow::startLogging()
 {
     QString defaultPath = QDir::homePath() + "/datalog.csv";
+    const QString wideFilter = tr("CSV, rivi per mittauskierros (*.csv)");
+    QString selectedFilter;
     QString filePath = QFileDialog::getSaveFileName(this, tr("Tallenna lokitiedosto"),
                                                     defaultPath,
-                                                    tr("CSV-tiedostot (*.csv);;Kaikki tiedostot (*.*)"));
+                                                    tr("CSV-tiedostot (*.csv);;%1;;Binäärilokit (*.gmlog);;Kaikki tiedostot (*.*)")
+                                                        .arg(wideFilter),
+                                                    &selectedFilter);
 
     if (!filePath.isEmpty()) {
+        logger->setCsvLayout(selectedFilter == wideFilter ? CsvLogWriter::Layout::Wide
+                                                          : CsvLogWriter::Layout::Long);
         logger->startLogging(filePath);
     }
 }
@@ -195,9 +624,51 @@ void MainWindow::updateLoggingStatus(bool isActive, const QString &filePath)
     }
 }
 
+QLabel *MainWindow::liveValueLabel(SensorType type) const
+{
+    switch (type) {
+    case SensorType::OIL_TEMPERATURE:
+        return ui->OilTemp;
+    case SensorType::AIR_TEMPERATURE:
+        return ui->AirTemp;
+    case SensorType::PRIMARY_AXLE_RPM:
+        return ui->PrimaryAxleRpm;
+    case SensorType::SECONDARY_AXLE_RPM:
+        return ui->SecondaryAxleRpm;
+    case SensorType::GEARBOX_TORQUE:
+        return ui->GearboxTorque;
+    case SensorType::BRAKE_TORQUE:
+        return ui->BrakeTorque;
+    case SensorType::GEAR_RATIO:
+        return ui->GearRatio;
+    case SensorType::INPUT_POWER:
+        return ui->InputPower;
+    case SensorType::OUTPUT_POWER:
+        return ui->OutputPower;
+    case SensorType::EFFICIENCY:
+        return ui->Efficiency;
+    default:
+        return nullptr;
+    }
+}
+
+void MainWindow::updateDeviceStatus(const DeviceStatus &status)
+{
+    deviceStatusLabel->setText(tr("Laite: pudotettu %1 kehystä, ylityksiä %2, viive max %3 µs / ka %4 µs, kadonneita kierroksia %5")
+                                   .arg(status.droppedFrames)
+                                   .arg(status.overruns)
+                                   .arg(status.maxLatenessUs)
+                                   .arg(status.meanLatenessUs)
+                                   .arg(status.lostCycles));
+
+    // Korostetaan, jos linja ruuhkautuu
+    const bool congested = status.droppedFrames > 0 || status.overruns > 0;
+    deviceStatusLabel->setStyleSheet(congested ? "color: orange;" : QString());
+}
+
 void MainWindow::on_actionDisconnect_triggered()
 {
-    receiver->disconnectFromPort();
+    QMetaObject::invokeMethod(receiver, &DataReceiver::disconnectFromPort);
 }
 
 void MainWindow::on_actionConnect_triggered()
@@ -208,7 +679,16 @@ void MainWindow::on_actionConnect_triggered()
         return;
     }
 
-    receiver->connectToPort(selectedPortName, selectedBaudRate);
+    const QString portName = selectedPortName;
+    const qint32 baudRate = selectedBaudRate;
+    m_liveChart->clear();
+    for (LiveStatistics &live : m_liveStatistics) {
+        live.statistics.clear();
+        live.label->clear();
+    }
+    QMetaObject::invokeMethod(receiver, [this, portName, baudRate]() {
+        receiver->connectToPort(portName, baudRate);
+    });
 }
 
 void MainWindow::showSerialPortList()
@@ -232,6 +712,25 @@ void MainWindow::showSerialPortList()
         ui->menuPort_COM->actions().first()->setChecked(true);
         selectedPortName = ui->menuPort_COM->actions().first()->text();
     }
+
+    // Vapaa polku esim. PC:llä ajettavan SensorController-ohjelman pseudopäätteelle
+    // (/dev/pts/N tai sen --link-polku), jota QSerialPortInfo ei luettele.
+    ui->menuPort_COM->addSeparator();
+    QAction *customPortAction = new QAction(tr("Muu portti..."), this);
+    customPortAction->setCheckable(true);
+    ui->menuPort_COM->addAction(customPortAction);
+    portGroup->addAction(customPortAction);
+
+    connect(customPortAction, &QAction::triggered, this, [this, customPortAction](){
+        bool ok = false;
+        const QString path = QInputDialog::getText(this, tr("Muu portti"),
+                                                   tr("Portin nimi tai polku:"),
+                                                   QLineEdit::Normal, selectedPortName, &ok).trimmed();
+        if (ok && !path.isEmpty()) {
+            selectedPortName = path;
+            customPortAction->setText(tr("Muu portti (%1)...").arg(path));
+        }
+    });
 }
 
 void MainWindow::showBaudRateList()
@@ -262,19 +761,116 @@ void MainWindow::showBaudRateList()
     }
 }
 
+void MainWindow::showStatisticsWindowList()
+{
+    QActionGroup *windowGroup = new QActionGroup(this);
+    windowGroup->setExclusive(true);
+
+    const QList<QPair<qint64, QString>> windows = {
+        { 1000, tr("1 s") },
+        { 10000, tr("10 s") },
+        { 60000, tr("60 s") },
+        { 600000, tr("10 min") },
+        { 0, QString() },
+    };
+
+    for (const auto &window : windows) {
+        const qint64 windowMs = window.first;
+        const QString description = window.second;
+        QAction *windowAction = new QAction(windowMs > 0 ? tr("Ikkuna %1").arg(description) : tr("Koko alue"), this);
+        windowAction->setCheckable(true);
+        windowAction->setChecked(windowMs == m_statisticsWindowMs);
+        ui->menuTilastot->addAction(windowAction);
+        windowGroup->addAction(windowAction);
+
+        connect(windowAction, &QAction::triggered, this, [this, windowMs, description](){
+            setStatisticsWindow(windowMs, description);
+        });
+        if (windowMs == m_statisticsWindowMs) {
+            setStatisticsWindow(windowMs, description);
+        }
+    }
+}
+
+void MainWindow::setupLiveStatistics()
+{
+    // Tunnusluvut lisätään reaaliaikaisen arvon alle samaan sarakkeeseen
+    const QList<QVBoxLayout *> layouts = ui->liveDataTab->findChildren<QVBoxLayout *>();
+    for (SensorType type : registeredSensors()) {
+        QLabel *valueLabel = liveValueLabel(type);
+        if (!valueLabel) {
+            continue;
+        }
+        for (QVBoxLayout *layout : layouts) {
+            if (layout->indexOf(valueLabel) < 0) {
+                continue;
+            }
+            LiveStatistics &live = m_liveStatistics[type];
+            live.statistics.setWindow(m_statisticsWindowMs);
+            live.label = new QLabel(this);
+            live.label->setAlignment(Qt::AlignCenter);
+            layout->addWidget(live.label);
+            break;
+        }
+    }
+}
+
+void MainWindow::setStatisticsWindow(qint64 windowMs, const QString &description)
+{
+    m_statisticsWindowMs = windowMs;
+    for (LiveStatistics &live : m_liveStatistics) {
+        live.statistics.setWindow(windowMs);
+        live.label->clear();
+    }
+
+    ui->valuesGroup->setTitle(windowMs > 0
+                                  ? tr("Arvot valitulla ajankohdalla (tunnusluvut edeltävältä %1)").arg(description)
+                                  : tr("Arvot valitulla ajankohdalla (tunnusluvut koko lokista)"));
+    if (ui->timeSlider->isEnabled()) {
+        onTimeSliderChanged(ui->timeSlider->value());
+    }
+}
+
+QString MainWindow::statisticsText(const StatisticsSummary &summary, int decimals) const
+{
+    if (summary.isEmpty()) {
+        return QString();
+    }
+    return tr("ka %1  rms %2  σ %3  min %4  max %5")
+        .arg(summary.mean, 0, 'f', decimals)
+        .arg(summary.rms(), 0, 'f', decimals)
+        .arg(summary.standardDeviation(), 0, 'f', decimals)
+        .arg(summary.min, 0, 'f', decimals)
+        .arg(summary.max, 0, 'f', decimals);
+}
+
 void MainWindow::onSensorSelectionChanged()
 {
-    QListWidgetItem *currentItem = ui->sensorListWidget->currentItem();
-    if (!currentItem) {
+    // Valitut kanavat piirretään päällekkäin listan järjestyksessä
+    QStringList names;
+    for (int row = 0; row < ui->sensorListWidget->count(); ++row) {
+        QListWidgetItem *item = ui->sensorListWidget->item(row);
+        if (item->isSelected() && m_sensorDataMap.contains(item->text())) {
+            names.append(item->text());
+        }
+    }
+    if (names.isEmpty()) {
         return;
     }
-    QString name = currentItem->text();
-    if (!m_sensorDataMap.contains(name)) {
+
+    QStringList shown;
+    for (const QString &name : std::as_const(names)) {
+        if (ensureChannelLoaded(name, names)) {
+            shown.append(name);
+        }
+    }
+    if (shown.isEmpty()) {
         return;
     }
+    m_shownChannels = shown;
 
-    // Poistetaan vanha sarja kaaviosta ilman että sitä tuhotaan,
-    // jotta voimme käyttää sitä uudelleen. Kaavio luopuu omistajuudesta.
+    // Poistetaan vanhat sarjat kaaviosta ilman että niitä tuhotaan,
+    // jotta voimme käyttää niitä uudelleen. Kaavio luopuu omistajuudesta.
     for (auto s : m_chart->series()) {
         m_chart->removeSeries(s);
     }
@@ -284,12 +880,10 @@ void MainWindow::onSensorSelectionChanged()
         delete axis;
     }
 
-    SensorChartData data = m_sensorDataMap[name];
-    m_chart->addSeries(data.series); // Kaavio ottaa taas omistajuuden
-
-    m_chart->setTitle(name);
+    const bool overlay = m_shownChannels.size() > 1;
+    m_chart->setTitle(m_shownChannels.join(", "));
 
-    // Luodaan akselit
+    // Kaikilla kanavilla on yhteinen aika-akseli
     QDateTimeAxis *axisX = new QDateTimeAxis;
     axisX->setTickCount(10);
     axisX->setFormat("hh:mm:ss.zzz");
@@ -297,20 +891,62 @@ void MainWindow::onSensorSelectionChanged()
     axisX->setRange(m_firstTimestamp, m_lastTimestamp);
     m_chart->addAxis(axisX, Qt::AlignBottom);
 
-    QValueAxis *axisY = new QValueAxis;
-    axisY->setTitleText(QString("Arvo (%1)").arg(data.unit));
-    m_chart->addAxis(axisY, Qt::AlignLeft);
+    // Yksi Y-akseli yksikköä kohden, vuorotellen vasemmalle ja oikealle.
+    // Vaihteluväli saadaan kanavien pyramidien juurista käymättä näytteitä läpi.
+    struct UnitAxis {
+        QValueAxis *axis = nullptr;
+        double minValue = 0.0;
+        double maxValue = 0.0;
+        bool hasRange = false;
+    };
+    QMap<QString, UnitAxis> unitAxes;
+    for (const QString &name : std::as_const(m_shownChannels)) {
+        SensorChartData &data = m_sensorDataMap[name];
+        if (!data.lod.isBuiltFor(data.data)) {
+            data.lod.build(data.data);
+        }
+        m_chart->addSeries(data.series); // Kaavio ottaa taas omistajuuden
 
-    // Kiinnitetään sarja akseleihin
-    data.series->attachAxis(axisX);
-    data.series->attachAxis(axisY);
-    
-    m_chart->legend()->hide();
+        UnitAxis &unitAxis = unitAxes[data.unit];
+        if (!unitAxis.axis) {
+            unitAxis.axis = new QValueAxis;
+            unitAxis.axis->setTitleText(QString("Arvo (%1)").arg(data.unit));
+            m_chart->addAxis(unitAxis.axis, unitAxes.size() % 2 ? Qt::AlignLeft : Qt::AlignRight);
+        }
+
+        if (!data.data.isEmpty()) {
+            qsizetype minIndex;
+            qsizetype maxIndex;
+            data.lod.range(data.data, 0, data.data.size(), minIndex, maxIndex);
+            const double minValue = data.data.values()[minIndex];
+            const double maxValue = data.data.values()[maxIndex];
+            unitAxis.minValue = unitAxis.hasRange ? qMin(unitAxis.minValue, minValue) : minValue;
+            unitAxis.maxValue = unitAxis.hasRange ? qMax(unitAxis.maxValue, maxValue) : maxValue;
+            unitAxis.hasRange = true;
+        }
+
+        // Kiinnitetään sarja akseleihin
+        data.series->attachAxis(axisX);
+        data.series->attachAxis(unitAxis.axis);
+    }
+
+    for (const UnitAxis &unitAxis : std::as_const(unitAxes)) {
+        if (unitAxis.hasRange) {
+            const double margin = unitAxis.maxValue > unitAxis.minValue
+                ? (unitAxis.maxValue - unitAxis.minValue) * 0.05 : 1.0;
+            unitAxis.axis->setRange(unitAxis.minValue - margin, unitAxis.maxValue + margin);
+        }
+    }
+
+    m_chart->legend()->setVisible(overlay);
+    updateSeriesDetail();
 
     // Päivitetään heti myös sliderin arvot
     onTimeSliderChanged(ui->timeSlider->value());
 
-    m_chart->axes(Qt::Vertical).first()->setTitleText("");
+    if (!overlay) {
+        m_chart->axes(Qt::Vertical).first()->setTitleText("");
+    }
 }
 
 void MainWindow::onTimeSliderChanged(int value)
@@ -339,45 +975,41 @@ void MainWindow::onTimeSliderChanged(int value)
         m_cursorTextItem->setFlag(QGraphicsItem::ItemIgnoresTransformations);
     }
 
-    QLineSeries* selectedSeries = nullptr;
-    QListWidgetItem* currentItem = ui->sensorListWidget->currentItem();
-    QString unit;
-    if (currentItem) {
-        QString selectedSensorName = currentItem->text();
-        if (m_sensorDataMap.contains(selectedSensorName)) {
-            selectedSeries = m_sensorDataMap[selectedSensorName].series;
-            unit = m_sensorDataMap[selectedSensorName].unit;
-        }
-    }
-
     qreal lineX = m_chart->mapToPosition(QPointF(timestampAtSlider, 0)).x();
     QRectF plotArea = m_chart->plotArea();
     m_cursorLine->setLine(lineX, plotArea.top(), lineX, plotArea.bottom());
     m_cursorLine->setVisible(true);
 
-    if(selectedSeries && selectedSeries->count() > 0){
-        QPointF closestPoint;
-        qreal minDist = -1.0;
+    // Kohdistimen tekstiin kaikkien näkyvien kanavien lähimmät arvot;
+    // teksti sijoitetaan ensimmäisen kanavan pisteen korkeudelle
+    QString text;
+    QPointF textPos;
+    for (const QString &name : std::as_const(m_shownChannels)) {
+        const auto it = m_sensorDataMap.constFind(name);
+        if (it == m_sensorDataMap.cend()) {
+            continue;
+        }
+        const SensorChartData &shown = it.value();
+        const qsizetype index = shown.data.nearestIndex(timestampAtSlider);
+        if (index < 0) {
+            continue;
+        }
+        const QPointF closestPoint(shown.data.timestamps()[index], shown.data.values()[index]);
 
-        const auto points = selectedSeries->pointsVector();
-        for (const QPointF &point : points) {
-            qreal dist = qAbs(point.x() - timestampAtSlider);
-            if (minDist < 0 || dist < minDist) {
-                minDist = dist;
-                closestPoint = point;
-            }
+        if (text.isEmpty()) {
+            QDateTime dt = QDateTime::fromMSecsSinceEpoch(qint64(closestPoint.x()));
+            text = QString("Aika: %1").arg(dt.toString("hh:mm:ss"));
+            textPos = m_chart->mapToPosition(closestPoint, shown.series);
         }
-        
-        QDateTime dt = QDateTime::fromMSecsSinceEpoch(qint64(closestPoint.x()));
-        QString text = QString("Aika: %1\nArvo: %2 %3")
-                           .arg(dt.toString("hh:mm:ss"))
-                           .arg(closestPoint.y())
-                           .arg(unit);
+        text += QString("\n%1: %2 %3")
+                    .arg(m_shownChannels.size() > 1 ? name : QString("Arvo"))
+                    .arg(closestPoint.y())
+                    .arg(shown.unit);
+    }
 
+    if (!text.isEmpty()) {
         m_cursorTextItem->setHtml(QString("<div style='background: rgba(30,30,30,0.8); color: white; padding: 4px; border-radius: 4px;'>%1</div>").arg(text.replace("\n", "<br/>")));
 
-        QPointF textPos = m_chart->mapToPosition(closestPoint);
-
         const qreal margin = 10;
         textPos.setX(lineX + margin);
 
@@ -398,36 +1030,95 @@ void MainWindow::onTimeSliderChanged(int value)
         m_cursorTextItem->setVisible(false);
     }
 
-    // Tyhjennetään vanhat arvot ja näytetään uudet kaikille sarjoille
+    // Puretut kanavat päivitetään heti. Purkamattomista puretaan kohdistimen
+    // kohdan lohko vasta, kun kohdistin pysähtyy, jotta liukusäätimen
+    // vetäminen ei pura lohkoa käyttöliittymän säikeessä joka askeleella.
+    m_valuesTimestampMs = timestampAtSlider;
+    updateValuesPanel(false);
+    m_unloadedValuesTimer.start();
+}
+
+void MainWindow::updateValuesPanel(bool unloaded)
+{
+    const qint64 timestampAtSlider = m_valuesTimestampMs;
+    for (auto it = m_sensorDataMap.begin(); it != m_sensorDataMap.end(); ++it) {
+        SensorChartData &sensorData = it.value();
+        if (!sensorData.valueLabel || sensorData.loaded == unloaded) {
+            continue;
+        }
+        double value = 0.0;
+        if (nearestValue(it.key(), timestampAtSlider, value)) {
+            sensorData.valueLabel->setText(QString::number(value, 'f', 2) + " " + sensorData.unit);
+        }
+
+        // Tunnusluvut lasketaan vain puretuista kanavista, jotta kohdistimen
+        // liike ei pura kokonaisia kanavia; puu rakennetaan ensimmäisellä
+        // haulla, minkä jälkeen jokainen haku on O(log n)
+        if (!sensorData.loaded) {
+            sensorData.statisticsLabel->setText(tr("ei ladattu"));
+            sensorData.statisticsLabel->setToolTip(tr("Valitse kanava, niin sen tunnusluvut lasketaan."));
+            continue;
+        }
+        sensorData.statisticsLabel->setToolTip(QString());
+        if (!sensorData.statistics.isBuiltFor(sensorData.data)) {
+            sensorData.statistics.build(sensorData.data);
+        }
+        const StatisticsSummary summary = m_statisticsWindowMs > 0
+            ? sensorData.statistics.range(sensorData.data, timestampAtSlider - m_statisticsWindowMs + 1, timestampAtSlider)
+            : sensorData.statistics.rangeByIndex(sensorData.data, 0, sensorData.data.size());
+        sensorData.statisticsLabel->setText(statisticsText(summary, sensorData.decimals));
+    }
+}
+
+void MainWindow::updateSeriesDetail()
+{
+    const QList<QAbstractAxis *> horizontal = m_chart->axes(Qt::Horizontal);
+    QDateTimeAxis *axisX = horizontal.isEmpty() ? nullptr : qobject_cast<QDateTimeAxis *>(horizontal.first());
+    if (!axisX) {
+        return;
+    }
+
+    // Pisteitä enintään neljä piirtoalueen pikseliä kohden, joten panorointi
+    // ja zoomaus eivät riipu kanavan näytemäärästä
+    // Ennen ensimmäistä asettelua piirtoalue on tyhjä; käytetään näkymän leveyttä
+    const int plotWidth = int(m_chart->plotArea().width());
+    const int pixelWidth = qMax(1, plotWidth > 1 ? plotWidth : ui->chartView->width());
+    for (const QString &name : std::as_const(m_shownChannels)) {
+        auto it = m_sensorDataMap.find(name);
+        if (it == m_sensorDataMap.end() || !it->loaded) {
+            continue;
+        }
+
+        SensorChartData &data = it.value();
+        if (!data.lod.isBuiltFor(data.data)) {
+            data.lod.build(data.data);
+        }
+        data.series->replace(data.lod.decimate(data.data, axisX->min().toMSecsSinceEpoch(),
+                                               axisX->max().toMSecsSinceEpoch(), pixelWidth));
+    }
+}
+
+void MainWindow::buildValuesPanel()
+{
     QLayoutItem* item;
     while ((item = ui->valuesLayout->takeAt(0)) != nullptr) {
         delete item->widget();
         delete item;
     }
 
+    // Rivit luodaan kerran lokia kohden; kohdistimen liike vain päivittää tekstit
     int row = 0;
-    for (const auto& sensorName : m_sensorDataMap.keys()) {
-        const auto& sensorData = m_sensorDataMap[sensorName];
-        if (sensorData.series && sensorData.series->count() > 0) {
-            QPointF closestPoint;
-            qreal minDist = -1.0;
-
-            const auto points = sensorData.series->pointsVector();
-            for (const QPointF &point : points) {
-                qreal dist = qAbs(point.x() - timestampAtSlider);
-                if (minDist < 0 || dist < minDist) {
-                    minDist = dist;
-                    closestPoint = point;
-                }
-            }
-            if (!closestPoint.isNull()) {
-                QLabel *nameLabel = new QLabel(sensorData.series->name(), this);
-                QLabel *valueLabel = new QLabel(QString::number(closestPoint.y(), 'f', 2) + " " + sensorData.unit, this);
-                ui->valuesLayout->addWidget(nameLabel, row, 0);
-                ui->valuesLayout->addWidget(valueLabel, row, 1);
-                row++;
-            }
+    for (SensorChartData &sensorData : m_sensorDataMap) {
+        if (!sensorData.series) {
+            continue;
         }
+        sensorData.nameLabel = new QLabel(sensorData.series->name(), this);
+        sensorData.valueLabel = new QLabel(this);
+        sensorData.statisticsLabel = new QLabel(this);
+        ui->valuesLayout->addWidget(sensorData.nameLabel, row, 0);
+        ui->valuesLayout->addWidget(sensorData.valueLabel, row, 1);
+        ui->valuesLayout->addWidget(sensorData.statisticsLabel, row, 2);
+        row++;
     }
 }
 
@@ -438,6 +1129,9 @@ void MainWindow::clearChartData()
         delete data.series;
     }
     m_sensorDataMap.clear();
+    m_shownChannels.clear();
+    m_unloadedValuesTimer.stop();
+    m_logIndex.clear();
     ui->sensorListWidget->clear();
 
     if (m_cursorLine) {
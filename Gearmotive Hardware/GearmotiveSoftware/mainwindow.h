@@ -3,8 +3,16 @@
 
 #include <QMainWindow>
 #include <QLabel>
+#include <QThread>
+#include <QTimer>
 #include "datareceiver.h"
 #include "datalogger.h"
+#include "channeldata.h"
+#include "lodpyramid.h"
+#include "logindex.h"
+#include "derivedchannelengine.h"
+#include "channelstatistics.h"
+#include "livechartwidget.h"
 #include <QtCharts/QChart>
 #include <QtCharts/QChartView>
 #include <QtCharts/QLineSeries>
@@ -14,6 +22,10 @@
 #include <QGraphicsTextItem>
 #include <QListWidget>
 #include <QDateTime>
+#include <QFuture>
+#include <atomic>
+
+class QFutureWatcherBase;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -33,6 +45,7 @@ private slots:
     void on_actionDisconnect_triggered();
     void on_actionConnect_triggered();
     void updateLoggingStatus(bool isActive, const QString &filePath);
+    void updateDeviceStatus(const DeviceStatus &status);
     void openLogFile();
     void onTimeSliderChanged(int value);
     void startLogging();
@@ -42,26 +55,80 @@ private slots:
 
 private:
     struct SensorChartData {
-        QLineSeries* series;
+        QLineSeries* series = nullptr;
         QString unit;
+        int decimals = 2;              // Rekisteröidyn anturin mukaan, jos nimi tunnetaan
+        ChannelData data;              // Aikajärjestyksessä kohdistimen hakuja varten
+        LodPyramid lod;                // Sarjaan viedään vain näkyvän alueen M4-pisteet
+        StatisticsTree statistics;     // Arvot-paneelin tunnusluvut aikaväliltä
+        QLabel *nameLabel = nullptr;   // Arvot-paneelin rivi
+        QLabel *valueLabel = nullptr;
+        QLabel *statisticsLabel = nullptr;
+        bool loaded = false;           // Näytteet purettu indeksistä
+        quint64 lastUsed = 0;          // Vapautusjärjestystä varten
+        const DerivedChannelEngine::Channel *derived = nullptr; // Lasketaan muista kanavista
+    };
+
+    // Reaaliaikaisen arvon liukuvat tunnusluvut ja niiden näyttö arvon alla
+    struct LiveStatistics {
+        RollingStatistics statistics;
+        QLabel *label = nullptr;
     };
 
+    // Purettujen kanavien yhteenlaskettu enimmäiskoko ennen vapauttamista
+    static constexpr qint64 ChannelMemoryBudget = 512 * 1024 * 1024;
+
+    // Purkamattomien kanavien arvot haetaan, kun kohdistin on ollut paikallaan näin kauan
+    static constexpr int UnloadedValuesDelayMs = 150;
+
     void showSerialPortList();
     void showBaudRateList();
+    void showStatisticsWindowList();
+    void setupLiveStatistics();
+    void setStatisticsWindow(qint64 windowMs, const QString &description);
+    QString statisticsText(const StatisticsSummary &summary, int decimals) const;
     void clearChartData();
+    void buildValuesPanel();
+    void updateSeriesDetail();
+    void updateValuesPanel(bool unloaded);
+    bool loadLogFile(const QString &filePath); // Ei tyhjennä aiempaa dataa
+    bool loadSession(const QString &manifestPath);
+    bool loadCsvLog(const QString &filePath);
+    bool loadBinaryLog(const QString &filePath);
+    void startCacheBuild(const QString &filePath);
+    void populateChannels();
+    bool ensureChannelLoaded(const QString &name, const QStringList &keep);
+    void evictChannels(const QStringList &keep);
+    bool nearestValue(const QString &name, qint64 timestampMs, double &value, qint64 *sampleMs = nullptr);
+    bool waitWithProgress(QFutureWatcherBase &watcher, const QString &label, int maximum);
+    QLabel *liveValueLabel(SensorType type) const;
 
     Ui::MainWindow *ui;
     DataReceiver *receiver;
+    QThread m_receiverThread;
     DataLogger *logger;
     QString selectedPortName;
     qint32 selectedBaudRate;
 
+    LiveChartWidget *m_liveChart;
+    QMap<SensorType, LiveStatistics> m_liveStatistics;
+    qint64 m_statisticsWindowMs = 10000; // 0 = koko loki tai yhteyden alusta
+
     QLabel *loggingStatusLabel;
+    QLabel *deviceStatusLabel;
 
     QChart *m_chart;
     QGraphicsLineItem *m_cursorLine;
     QGraphicsTextItem *m_cursorTextItem;
     QMap<QString, SensorChartData> m_sensorDataMap;
+    QStringList m_shownChannels; // Kaaviossa päällekkäin näkyvät kanavat
+    QTimer m_unloadedValuesTimer;
+    qint64 m_valuesTimestampMs = 0; // Arvot-paneelin kohdistimen hetki
+    LogIndex m_logIndex;
+    DerivedChannelEngine m_derivedChannels; // Lokin laskennalliset kanavat
+    quint64 m_useCounter = 0;
+    QMap<QString, QFuture<void>> m_cacheBuilds; // Lokin polku -> taustalla kirjoitettava välimuisti
+    std::atomic_bool m_cacheStop { false };
     QDateTime m_firstTimestamp;
     QDateTime m_lastTimestamp;
 };
@@ -0,0 +1,88 @@
+#include "sensordata.h"
+
+#include <array>
+
+namespace {
+
+// Sisäänrakennetut anturit. Uusi anturi lisätään tähän taulukkoon tai
+// rekisteröidään ajonaikaisesti registerSensor()-funktiolla.
+const SensorInfo BUILTIN_SENSORS[] = {
+    { SensorType::OIL_TEMPERATURE,    WireFormat::Float32, 1.0,           0.0, QStringLiteral("Öljylämpötila"),      QStringLiteral("°C"),  1 },
+    { SensorType::PRIMARY_AXLE_RPM,   WireFormat::UInt16,  1.0,           0.0, QStringLiteral("Ensiöakseli"),        QStringLiteral("rpm"), 1 },
+    { SensorType::SECONDARY_AXLE_RPM, WireFormat::UInt16,  1.0,           0.0, QStringLiteral("Toisioakseli"),       QStringLiteral("rpm"), 1 },
+    { SensorType::GEARBOX_TORQUE,     WireFormat::Float32, 1.0,           0.0, QStringLiteral("Vaihteiston vääntö"), QStringLiteral("Nm"),  1 },
+    { SensorType::BRAKE_TORQUE,       WireFormat::Float32, 1.0,           0.0, QStringLiteral("Jarrun vääntö"),      QStringLiteral("Nm"),  1 },
+    { SensorType::AIR_TEMPERATURE,    WireFormat::Float32, 1.0,           0.0, QStringLiteral("Ilman lämpötila"),    QStringLiteral("°C"),  1 },
+    // Kiihtyvyysanturi (ADXL354) lähettää milli-g:nä
+    { SensorType::ACCELERATION_X,     WireFormat::Int16,   0.001,         0.0, QStringLiteral("Kiihtyvyys X"),       QStringLiteral("g"),   3 },
+    { SensorType::ACCELERATION_Y,     WireFormat::Int16,   0.001,         0.0, QStringLiteral("Kiihtyvyys Y"),       QStringLiteral("g"),   3 },
+    { SensorType::ACCELERATION_Z,     WireFormat::Int16,   0.001,         0.0, QStringLiteral("Kiihtyvyys Z"),       QStringLiteral("g"),   3 },
+    // Mikrofonivahvistimen (MAX4466) verhokäyrä 12-bittisenä ADC-lukemana
+    { SensorType::SOUND_LEVEL,        WireFormat::UInt16,  3.3 / 4095.0,  0.0, QStringLiteral("Äänitaso"),           QStringLiteral("V"),   3 },
+    // Laskennalliset kanavat, ks. DerivedChannelEngine::defaultDefinitions()
+    { SensorType::GEAR_RATIO,         WireFormat::Float32, 1.0,           0.0, QStringLiteral("Välityssuhde"),       QString(),             3 },
+    { SensorType::INPUT_POWER,        WireFormat::Float32, 1.0,           0.0, QStringLiteral("Tuloteho"),           QStringLiteral("kW"),  2 },
+    { SensorType::OUTPUT_POWER,       WireFormat::Float32, 1.0,           0.0, QStringLiteral("Lähtöteho"),          QStringLiteral("kW"),  2 },
+    { SensorType::EFFICIENCY,         WireFormat::Float32, 1.0,           0.0, QStringLiteral("Hyötysuhde"),         QStringLiteral("%"),   1 },
+};
+
+const SensorInfo UNKNOWN_SENSOR = {
+    SensorType::UNKNOWN, WireFormat::UInt8, 1.0, 0.0, QStringLiteral("Tuntematon"), QString(), 2
+};
+
+// Hakutaulukko tyyppitavun mukaan, jotta purku on yksi indeksointi
+struct Registry {
+    std::array<SensorInfo, 256> sensors;
+    std::array<bool, 256> present {};
+};
+
+Registry &registry()
+{
+    static Registry instance = []() {
+        Registry r;
+        for (const SensorInfo &info : BUILTIN_SENSORS) {
+            r.sensors[quint8(info.type)] = info;
+            r.present[quint8(info.type)] = true;
+        }
+        return r;
+    }();
+    return instance;
+}
+
+} // namespace
+
+const SensorInfo *findSensor(quint8 typeId)
+{
+    const Registry &r = registry();
+    return r.present[typeId] ? &r.sensors[typeId] : nullptr;
+}
+
+const SensorInfo &sensorInfo(SensorType type)
+{
+    const SensorInfo *info = findSensor(quint8(type));
+    return info ? *info : UNKNOWN_SENSOR;
+}
+
+void registerSensor(const SensorInfo &info)
+{
+    Registry &r = registry();
+    r.sensors[quint8(info.type)] = info;
+    r.present[quint8(info.type)] = true;
+}
+
+QList<SensorType> registeredSensors()
+{
+    QList<SensorType> types;
+    const Registry &r = registry();
+    for (int id = 0; id < 256; ++id) {
+        if (r.present[id]) {
+            types.append(static_cast<SensorType>(id));
+        }
+    }
+    return types;
+}
+
+QString formatSensorValue(const SensorSample &sample)
+{
+    return QString::number(sample.value, 'f', sensorInfo(sample.type).decimals);
+}
@@ -1,8 +1,11 @@
 #ifndef SENSORDATA_H
 #define SENSORDATA_H
 
-#include <QVariant>
+#include <QList>
+#include <QMetaType>
 #include <QString>
+#include <QtEndian>
+#include <type_traits>
 
 // Tämän enumin tulee vastata STM32 enumia.
 enum class SensorType : quint8 {
@@ -12,15 +15,119 @@ enum class SensorType : quint8 {
     GEARBOX_TORQUE = 0x30,
     BRAKE_TORQUE = 0x31,
     AIR_TEMPERATURE = 0x40,
+    ACCELERATION_X = 0x50,
+    ACCELERATION_Y = 0x51,
+    ACCELERATION_Z = 0x52,
+    SOUND_LEVEL = 0x60,
+    // Laskennalliset kanavat (0xC0-0xCF). Laite ei lähetä näitä, vaan ne
+    // lasketaan mitatuista kanavista (DerivedChannelEngine).
+    GEAR_RATIO = 0xC0,
+    INPUT_POWER = 0xC1,
+    OUTPUT_POWER = 0xC2,
+    EFFICIENCY = 0xC3,
     UNKNOWN = 0xFF
 };
 
-// Säilöö datan
-struct SensorData {
+// Yksi mittausnäyte. Rakenne on tarkoituksella pelkkää dataa, jotta sitä voi
+// kopioida ja säilöä eränä ilman muistinvarauksia. Nimi ja yksikkö haetaan
+// tarvittaessa sensorInfo()-taulukosta.
+struct SensorSample {
+    qint64 timestampMs; // Millisekunteja epochista
+    double value;
     SensorType type;
+};
+
+static_assert(std::is_trivially_copyable<SensorSample>::value, "SensorSample must stay trivially copyable");
+
+// Arvon esitysmuoto sarjaväylällä. Kaikki monitavuiset arvot ovat little-endian.
+enum class WireFormat : quint8 {
+    UInt8,
+    Int8,
+    UInt16,
+    Int16,
+    UInt32,
+    Int32,
+    Float32
+};
+
+constexpr int wireSize(WireFormat format)
+{
+    switch (format) {
+    case WireFormat::UInt8:
+    case WireFormat::Int8:
+        return 1;
+    case WireFormat::UInt16:
+    case WireFormat::Int16:
+        return 2;
+    case WireFormat::UInt32:
+    case WireFormat::Int32:
+    case WireFormat::Float32:
+        return 4;
+    }
+    return 0;
+}
+
+// Anturityypin kuvaus: miten arvo puretaan ja miten se näytetään.
+// Fysikaalinen arvo = raaka-arvo * scale + offset.
+struct SensorInfo {
+    SensorType type;
+    WireFormat format;
+    double scale;
+    double offset;
     QString name;
-    QVariant value;
     QString unit;
+    int decimals; // Desimaalit näytössä ja lokissa
 };
 
-#endif // SENSORDATA_H 
\ No newline at end of file
+/**
+ * @brief Palauttaa anturityypin tiedot tai nullptr, jos tyyppiä ei ole rekisteröity.
+ *
+ * Haku on suora taulukkohaku tyyppitavun perusteella.
+ */
+const SensorInfo *findSensor(quint8 typeId);
+
+/**
+ * @brief Palauttaa anturityypin tiedot. Tuntemattomalle tyypille palautetaan UNKNOWN-rivi.
+ */
+const SensorInfo &sensorInfo(SensorType type);
+
+/**
+ * @brief Rekisteröi uuden anturityypin tai korvaa olemassa olevan kuvauksen.
+ *
+ * Tarkoitettu kutsuttavaksi ohjelman käynnistyessä ennen kuin vastaanotto alkaa;
+ * rekisteriä luetaan muista säikeistä ilman lukitusta.
+ */
+void registerSensor(const SensorInfo &info);
+
+/**
+ * @brief Palauttaa kaikki rekisteröidyt anturityypit tyyppitunnisteen mukaan järjestettynä.
+ */
+QList<SensorType> registeredSensors();
+
+/**
+ * @brief Purkaa raaka-arvon suoraan little-endian-muodosta ja skaalaa sen.
+ * @param data Osoitin vähintään wireSize(info.format) tavun dataan.
+ */
+inline double decodeSensorValue(const SensorInfo &info, const uchar *data)
+{
+    double raw = 0.0;
+    switch (info.format) {
+    case WireFormat::UInt8:   raw = data[0]; break;
+    case WireFormat::Int8:    raw = static_cast<qint8>(data[0]); break;
+    case WireFormat::UInt16:  raw = qFromLittleEndian<quint16>(data); break;
+    case WireFormat::Int16:   raw = qFromLittleEndian<qint16>(data); break;
+    case WireFormat::UInt32:  raw = qFromLittleEndian<quint32>(data); break;
+    case WireFormat::Int32:   raw = qFromLittleEndian<qint32>(data); break;
+    case WireFormat::Float32: raw = qFromLittleEndian<float>(data); break;
+    }
+    return raw * info.scale + info.offset;
+}
+
+/**
+ * @brief Muotoilee näytteen arvon anturin desimaalitarkkuudella ilman yksikköä.
+ */
+QString formatSensorValue(const SensorSample &sample);
+
+Q_DECLARE_METATYPE(SensorSample)
+
+#endif // SENSORDATA_H
@@ -1,27 +1,174 @@
 #include "Communication.h"
-#include "Sensor.h"
+#include "Scheduler.h"
 #include <Arduino.h>
+#include <string.h>
+
+namespace {
+
+const uint8_t HEADER_SIZE = 2;        // type + len; koodaus lisää loput lähetettäessä
+const uint8_t MAX_PAYLOAD = TX_SLOT_SIZE - HEADER_SIZE;
+const uint8_t BATCH_HEADER_SIZE = 6;  // sekvenssi + aikaleima
+const uint8_t CONTROL_PRIORITY = 0xFF; // Tila- ja ohjauskehyksiä ei pudoteta antureiden hyväksi
+const uint32_t STATUS_KEY = 0xFFFFFFFF;
+const uint32_t PROTOCOL_KEY = 0xFFFFFFFE;
+
+const uint8_t COMMAND_START_BYTE = 0xAA;
+const uint8_t MAX_COMMAND_PAYLOAD = 4;
+
+TxQueue txQueue(DROP_OLDEST);
+ProtocolVersion activeVersion = PROTOCOL_V1;
+
+/**
+ * @brief Isännän komentojen vastaanotto. Komennot ovat versio 1 -kehyksiä.
+ */
+class CommandReader {
+public:
+    /**
+     * @brief Lukee saatavilla olevat tavut odottamatta ja suorittaa valmiit komennot.
+     */
+    void poll() {
+        while (Serial.available() > 0) {
+            uint8_t byte = (uint8_t)Serial.read();
+            if (pos == 0 && byte != COMMAND_START_BYTE) {
+                continue;
+            }
+            buffer[pos++] = byte;
+            if (pos == 3 && buffer[2] > MAX_COMMAND_PAYLOAD) {
+                pos = 0; // Ei komento, etsitään seuraava aloitusmerkki
+            } else if (pos >= 3 && pos == buffer[2] + 4) {
+                handle();
+                pos = 0;
+            }
+        }
+    }
+
+private:
+    void handle() {
+        uint8_t len = buffer[2];
+        uint8_t checksum = 0;
+        for (uint8_t i = 0; i < len + 3; ++i) {
+            checksum ^= buffer[i];
+        }
+        if (checksum != buffer[len + 3]) {
+            return;
+        }
+
+        if (buffer[1] == PROTOCOL_FRAME && len == 1) {
+            // Tuntematon versio kuitataan nykyisellä, jolloin isäntä tietää pysyä siinä
+            uint8_t requested = buffer[3];
+            bool supported = requested == PROTOCOL_V1 || requested == PROTOCOL_V2;
+            setProtocolVersion(supported ? (ProtocolVersion)requested : activeVersion);
+        }
+    }
+
+    uint8_t buffer[MAX_COMMAND_PAYLOAD + 4];
+    uint8_t pos = 0;
+};
+
+CommandReader commandReader;
+
+void putUint32(uint8_t* dst, uint32_t value) {
+    dst[0] = value & 0xFF;
+    dst[1] = (value >> 8) & 0xFF;
+    dst[2] = (value >> 16) & 0xFF;
+    dst[3] = (value >> 24) & 0xFF;
+}
+
+/**
+ * @brief Täydentää kehyksen otsikon ja lisää sen lähetysjonoon.
+ */
+void sendFrame(uint8_t* frame, uint8_t type, uint8_t len, uint8_t priority, uint32_t key) {
+    frame[0] = type;
+    frame[1] = len;
+    txQueue.enqueue(frame, HEADER_SIZE + len, priority, key);
+}
+
+} // namespace
+
+void beginCommunication(TxOverflowPolicy policy) {
+    txQueue.setPolicy(policy);
+}
+
+void pumpCommunication() {
+    commandReader.poll();
+    txQueue.pump();
+}
+
+void setProtocolVersion(ProtocolVersion version) {
+    activeVersion = version;
+    txQueue.setEncoder(version == PROTOCOL_V2 ? encodeFrameV2 : encodeFrameV1);
+
+    uint8_t frame[HEADER_SIZE + 1];
+    frame[HEADER_SIZE] = version;
+    sendFrame(frame, PROTOCOL_FRAME, 1, CONTROL_PRIORITY, PROTOCOL_KEY);
+}
+
+void sendStatus(const SchedulerStats& stats) {
+    uint8_t frame[HEADER_SIZE + 16];
+    uint8_t* payload = frame + HEADER_SIZE;
+    putUint32(payload, txQueue.takeDroppedFrames());
+    putUint32(payload + 4, stats.overruns);
+    putUint32(payload + 8, stats.maxLatenessUs);
+    putUint32(payload + 12, stats.meanLatenessUs);
+    sendFrame(frame, STATUS_FRAME, 16, CONTROL_PRIORITY, STATUS_KEY);
+}
 
 /**
  * @brief Muodostaa ja lähettää datapaketin sarjaportin yli.
  */
-void sendSensorData(Sensor* sensor) {
-    uint8_t startByte = 0xAA;
-    SensorType type = sensor->getType();
-    uint8_t len = sensor->getDataSize();
-    uint8_t* data = sensor->getData();
-    
-    uint8_t checksum = 0;
-    checksum ^= startByte;
-    checksum ^= (uint8_t)type;
-    checksum ^= len;
-    for (int i = 0; i < len; ++i) {
-        checksum ^= data[i];
+void sendSensorData(uint8_t type, const uint8_t* data, uint8_t len, uint8_t priority) {
+    uint8_t frame[HEADER_SIZE + MAX_PAYLOAD];
+    if (len > MAX_PAYLOAD) {
+        return;
+    }
+    memcpy(frame + HEADER_SIZE, data, len);
+    sendFrame(frame, type, len, priority, type);
+}
+
+// ------ BatchWriter toteutus ------
+
+BatchWriter::BatchWriter(uint16_t sequence, uint32_t timestamp)
+    : sequence(sequence), timestamp(timestamp), sentAny(false) {
+    start();
+}
+
+void BatchWriter::start() {
+    uint8_t* payload = frame + HEADER_SIZE;
+    payload[0] = sequence & 0xFF;
+    payload[1] = sequence >> 8;
+    putUint32(payload + 2, timestamp);
+    len = BATCH_HEADER_SIZE;
+    priority = 0;
+    key = 0;
+}
+
+void BatchWriter::flush() {
+    sendFrame(frame, BATCH_FRAME, len, priority, key);
+    sentAny = true;
+    start();
+}
+
+void BatchWriter::add(uint8_t type, const uint8_t* data, uint8_t size, uint8_t sensorPriority) {
+    if (BATCH_HEADER_SIZE + 1 + size > MAX_PAYLOAD) {
+        return; // Ei mahdu yksinäänkään kehykseen
     }
+    if (len + 1 + size > MAX_PAYLOAD) {
+        flush();
+    }
+
+    uint8_t* payload = frame + HEADER_SIZE;
+    payload[len++] = type;
+    memcpy(payload + len, data, size);
+    len += size;
+    if (sensorPriority > priority) {
+        priority = sensorPriority;
+    }
+    key = key * 31 + type;
+}
 
-    Serial.write(startByte);
-    Serial.write((uint8_t)type);
-    Serial.write(len);
-    Serial.write(data, len);
-    Serial.write(checksum);
-} 
\ No newline at end of file
+bool BatchWriter::finish() {
+    if (len > BATCH_HEADER_SIZE) {
+        flush();
+    }
+    return sentAny;
+}
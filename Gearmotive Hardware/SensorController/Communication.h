@@ -1,17 +1,115 @@
 #pragma once
 
-class Sensor; // Eteenpäin suuntautuva viittaus (forward declaration)
+#include <stdint.h>
+#include "TxQueue.h"
+
+struct SchedulerStats; // Eteenpäin suuntautuva viittaus (forward declaration)
+
+// Kehystyypit 0x01-0x0F on varattu ohjauskehyksille, anturityypit alkavat 0x10:stä.
+enum FrameType : uint8_t {
+    BATCH_FRAME = 0x01,
+    STATUS_FRAME = 0x02,
+    /**
+     * Isännältä tuleva komento: 1 tavu, haluttu protokollaversio. Komento
+     * lähetetään aina versiolla 1 koodattuna. Laite vastaa samantyyppisellä
+     * kehyksellä, jonka data on käyttöön otettu versio; vastaus ja kaikki
+     * sen jälkeiset kehykset on koodattu uudella versiolla.
+     */
+    PROTOCOL_FRAME = 0x03,
+};
+
+/**
+ * @brief Alustaa lähetysjonon. Kutsutaan kerran setup()-funktiossa Serial.begin():n jälkeen.
+ *
+ * Kaikki lähetysfunktiot lisäävät kehyksen jonoon eivätkä koskaan odota UARTia.
+ * Jonoa tyhjennetään pumpCommunication()-kutsuilla.
+ *
+ * @param policy Mitä tehdään, kun jono on täynnä.
+ */
+void beginCommunication(TxOverflowPolicy policy);
+
+/**
+ * @brief Siirtää jonossa olevaa dataa UARTiin odottamatta ja käsittelee isännän komennot.
+ *
+ * Kutsutaan jokaisella loop()-kierroksella.
+ */
+void pumpCommunication();
+
+/**
+ * @brief Lähettää tilakehyksen, jolla isäntä näkee linjan ruuhkautumisen.
+ *
+ * Kehyksen data (kaikki little-endian u32):
+ * - Pudotetut kehykset edellisestä tilakehyksestä
+ * - Ajastimen ylitykset
+ * - Suurin myöhästyminen mikrosekunteina
+ * - Keskimääräinen myöhästyminen mikrosekunteina
+ *
+ * @param stats Ajastimen tilastot edellisestä tilakehyksestä lähtien.
+ */
+void sendStatus(const SchedulerStats& stats);
 
 /**
- * @brief Muodostaa ja lähettää datapaketin sarjaportin yli.
+ * @brief Vaihtaa kehysformaatin. Koskee kehyksiä, joiden lähetys ei ole vielä alkanut.
+ *
+ * Lähettää PROTOCOL_FRAME-kuittauksen uudella versiolla.
+ */
+void setProtocolVersion(ProtocolVersion version);
+
+/**
+ * @brief Muodostaa ja lähettää yksittäisen anturin datapaketin sarjaportin yli.
  * 
- * Paketin formaatti:
- * - 1 tavu: Aloitusmerkki (0xAA)
- * - 1 tavu: Anturin tyyppi (SensorType)
- * - 1 tavu: Datan pituus
- * - N tavua: Data
- * - 1 tavu: Tarkistussumma (XOR)
+ * Paketin tyyppi on anturin tyyppi (SensorType), ja se koodataan käytössä
+ * olevan protokollaversion mukaan (ks. Framing.h).
  * 
- * @param sensor Osoitin sensoriin, jonka data lähetetään.
+ * @param type Anturin tyyppi.
+ * @param data Anturin data.
+ * @param len Datan pituus.
+ * @param priority Lähetysprioriteetti.
+ */
+void sendSensorData(uint8_t type, const uint8_t* data, uint8_t len, uint8_t priority);
+
+/**
+ * @brief Kokoaa yhden mittauskierroksen anturit eräkehyksiksi.
+ *
+ * Kehys on muuten samanlainen kuin sendSensorData():ssa, mutta tyyppinä on
+ * BATCH_FRAME ja data on muotoa:
+ * - 2 tavua: Kierroksen sekvenssinumero (little-endian)
+ * - 4 tavua: Laitteen aika millisekunteina (little-endian)
+ * - Jokaiselle anturille 1 tavu tyyppi + anturin data
+ *
+ * Jos anturit eivät mahdu yhteen kehykseen (TX_SLOT_SIZE), täysi kehys
+ * lähetetään ja loput jatkuvat seuraavassa kehyksessä samalla
+ * sekvenssinumerolla ja ajalla. Kehyksen prioriteetti on sen tärkeimmän
+ * anturin prioriteetti.
  */
-void sendSensorData(Sensor* sensor); 
\ No newline at end of file
+class BatchWriter {
+public:
+    /**
+     * @param sequence Mittauskierroksen sekvenssinumero.
+     * @param timestamp Mittauskierroksen aika (millis()).
+     */
+    BatchWriter(uint16_t sequence, uint32_t timestamp);
+
+    /**
+     * @brief Lisää anturin arvon kehykseen.
+     */
+    void add(uint8_t type, const uint8_t* data, uint8_t size, uint8_t priority);
+
+    /**
+     * @brief Lähettää keskeneräisen kehyksen.
+     * @return true, jos kierroksesta lähetettiin ainakin yksi kehys.
+     */
+    bool finish();
+
+private:
+    void start();
+    void flush();
+
+    uint8_t frame[TX_SLOT_SIZE];
+    uint16_t sequence;
+    uint32_t timestamp;
+    uint8_t len;
+    uint8_t priority;
+    uint32_t key; // Sama anturijoukko tuottaa saman avaimen
+    bool sentAny;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Sarjaväylän kehysformaatin versio.
+ *
+ * Laite käynnistyy versiossa 1, jotta vanhat vastaanottajat toimivat.
+ * Isäntä voi vaihtaa version lähettämällä PROTOCOL_FRAME-kehyksen, jonka
+ * datana on pyydetty versio; laite kuittaa samalla kehystyypillä.
+ */
+enum ProtocolVersion : uint8_t {
+    /**
+     * Versio 1:
+     * - 1 tavu: Aloitusmerkki (0xAA)
+     * - 1 tavu: Kehyksen tyyppi
+     * - 1 tavu: Datan pituus
+     * - N tavua: Data
+     * - 1 tavu: Tarkistussumma (XOR)
+     */
+    PROTOCOL_V1 = 1,
+    /**
+     * Versio 2: COBS-koodattu (tyyppi, data, CRC-16) ja perään erotin 0x00.
+     * Koodatussa kehyksessä ei ole nollatavuja, joten vastaanottaja löytää
+     * kehysrajan aina seuraavasta nollasta. CRC-16/CCITT-FALSE (polynomi
+     * 0x1021, alkuarvo 0xFFFF) lasketaan tyypistä ja datasta ja lähetetään
+     * little-endian.
+     */
+    PROTOCOL_V2 = 2,
+};
+
+/**
+ * @brief Koodatun kehyksen enimmäiskoko, kun koodaamaton kehys on @p rawSize tavua.
+ *
+ * Versio 2: tyyppi + data + CRC (rawSize + 1), COBS-ylimäärä 1 tavu ja erotin.
+ */
+#define WIRE_FRAME_SIZE(rawSize) ((rawSize) + 3)
+
+/**
+ * @brief Laskee CRC-16/CCITT-FALSE-tarkistussumman taulukon avulla.
+ * @param crc Edellinen arvo, jos summa lasketaan osissa.
+ */
+uint16_t crc16Ccitt(const uint8_t* data, uint8_t len, uint16_t crc = 0xFFFF);
+
+/**
+ * @brief Koodaa kehyksen versiolla 1.
+ * @param raw Koodaamaton kehys: tyyppi, datan pituus ja data.
+ * @param rawSize Koodaamattoman kehyksen koko.
+ * @param wire Kohde, vähintään WIRE_FRAME_SIZE(rawSize) tavua.
+ * @return Koodatun kehyksen koko.
+ */
+uint8_t encodeFrameV1(const uint8_t* raw, uint8_t rawSize, uint8_t* wire);
+
+/**
+ * @brief Koodaa kehyksen versiolla 2. Parametrit kuten encodeFrameV1():ssä.
+ */
+uint8_t encodeFrameV2(const uint8_t* raw, uint8_t rawSize, uint8_t* wire);
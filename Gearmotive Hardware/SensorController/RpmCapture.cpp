@@ -0,0 +1,54 @@
+#include "RpmCapture.h"
+#include <Arduino.h>
+
+RpmCapture::RpmCapture(uint8_t pin, uint16_t teethPerRevolution)
+    : pin(pin),
+      teethPerRevolution(teethPerRevolution > 0 ? teethPerRevolution : 1),
+      rpm(0),
+      lastEdgeUs(0),
+      hasEdge(false),
+      droppedEdges(0) {
+}
+
+void RpmCapture::begin(void (*isr)()) {
+    pinMode(pin, INPUT);
+    attachInterrupt(digitalPinToInterrupt(pin), isr, RISING);
+}
+
+void RpmCapture::onEdge() {
+    uint32_t now = micros();
+    if (hasEdge.load(std::memory_order_relaxed)) {
+        // Pysähdyksen jälkeinen ensimmäinen väli on koko pysähdysaika eikä
+        // kuvaa nopeutta, joten sitä ei kirjata
+        uint32_t period = now - lastEdgeUs.load(std::memory_order_relaxed);
+        if (period <= STOP_TIMEOUT_US && !periods.push(period)) {
+            droppedEdges.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    lastEdgeUs.store(now, std::memory_order_relaxed);
+    hasEdge.store(true, std::memory_order_release);
+}
+
+uint16_t RpmCapture::read() {
+    uint64_t totalUs = 0;
+    uint32_t count = 0;
+    uint32_t period;
+    while (periods.pop(period)) {
+        totalUs += period;
+        ++count;
+    }
+
+    if (count > 0 && totalUs > 0) {
+        // rpm = 60 s / (keskimääräinen pulssiväli * hampaat)
+        uint64_t value = (60000000ULL * count) / (totalUs * teethPerRevolution);
+        rpm = value > 0xFFFF ? 0xFFFF : (uint16_t)value;
+    } else if (!hasEdge.load(std::memory_order_acquire)
+               || (uint32_t)(micros() - lastEdgeUs.load(std::memory_order_relaxed)) > STOP_TIMEOUT_US) {
+        rpm = 0;
+    }
+    return rpm;
+}
+
+void RpmCapture::setTeethPerRevolution(uint16_t teeth) {
+    teethPerRevolution = teeth > 0 ? teeth : 1;
+}
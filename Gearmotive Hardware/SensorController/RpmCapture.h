@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include "SpscRing.h"
+
+/**
+ * @brief Mittaa kierrosnopeuden hammasrattaan pulssien väliajoista.
+ *
+ * Hall-anturin pulssin nouseva reuna laukaisee keskeytyksen, joka tallentaa
+ * vain edellisestä reunasta kuluneen ajan lukituksettomaan rengaspuskuriin.
+ * Kaikki laskenta tehdään read()-funktiossa loop()-puolella, jotta
+ * keskeytyspalvelu pysyy lyhyenä eikä viivästytä sarjalähetystä.
+ */
+class RpmCapture {
+public:
+    /**
+     * @param pin Digitaalinen tulonasta, jonka keskeytystä käytetään.
+     * @param teethPerRevolution Hammasrattaan hampaiden määrä (pulssia kierroksella).
+     */
+    RpmCapture(uint8_t pin, uint16_t teethPerRevolution);
+
+    /**
+     * @brief Määrittää nastan ja kytkee keskeytyksen.
+     * @param isr Vapaa funktio, joka kutsuu tämän olion onEdge()-metodia.
+     */
+    void begin(void (*isr)());
+
+    /**
+     * @brief Kirjaa pulssin reunan. Kutsutaan vain keskeytyspalvelusta.
+     */
+    void onEdge();
+
+    /**
+     * @brief Tyhjentää kertyneet pulssivälit ja laskee niistä kierrosnopeuden.
+     * @return Kierrosnopeus (rpm). Jos uusia pulsseja ei ole tullut, palautetaan
+     *         edellinen arvo; jos pulsseja ei ole tullut STOP_TIMEOUT_US aikana, 0.
+     */
+    uint16_t read();
+
+    void setTeethPerRevolution(uint16_t teeth);
+
+    /**
+     * @brief Palauttaa pulssien määrän, jotka hylättiin täyden puskurin takia.
+     */
+    uint32_t getDroppedEdges() const { return droppedEdges.load(std::memory_order_relaxed); }
+
+private:
+    static const uint32_t STOP_TIMEOUT_US = 500000; // Akselin katsotaan pysähtyneen
+
+    uint8_t pin;
+    uint16_t teethPerRevolution;
+    uint16_t rpm;
+
+    SpscRing<uint32_t, 64> periods; // Pulssivälit mikrosekunteina
+
+    // Vain keskeytyspalvelu kirjoittaa näitä
+    std::atomic<uint32_t> lastEdgeUs;
+    std::atomic<bool> hasEdge;
+    std::atomic<uint32_t> droppedEdges;
+};
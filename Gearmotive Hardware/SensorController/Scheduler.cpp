@@ -0,0 +1,44 @@
+#include "Scheduler.h"
+
+DeadlineTracker::DeadlineTracker()
+    : overruns(0),
+      maxLatenessUs(0),
+      totalLatenessUs(0),
+      executions(0) {
+}
+
+bool DeadlineTracker::due(uint32_t& deadline, uint32_t period, uint32_t nowUs) {
+    // Etumerkillinen erotus toimii myös micros()-laskurin pyörähtäessä ympäri
+    int32_t lateness = (int32_t)(nowUs - deadline);
+    if (lateness < 0) {
+        return false;
+    }
+
+    ++executions;
+    totalLatenessUs += (uint32_t)lateness;
+    if ((uint32_t)lateness > maxLatenessUs) {
+        maxLatenessUs = (uint32_t)lateness;
+    }
+
+    deadline += period;
+    if ((int32_t)(nowUs - deadline) >= 0) {
+        // Kokonainen jakso jäi väliin: ei yritetä kiriä kiinni vaan jatketaan nykyhetkestä
+        overruns += (nowUs - deadline) / period + 1;
+        deadline = nowUs + period;
+    }
+    return true;
+}
+
+SchedulerStats DeadlineTracker::takeStats() {
+    SchedulerStats stats;
+    stats.overruns = overruns;
+    stats.maxLatenessUs = maxLatenessUs;
+    stats.meanLatenessUs = executions > 0 ? (uint32_t)(totalLatenessUs / executions) : 0;
+    stats.executions = executions;
+
+    overruns = 0;
+    maxLatenessUs = 0;
+    totalLatenessUs = 0;
+    executions = 0;
+    return stats;
+}
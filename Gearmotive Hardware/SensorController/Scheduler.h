@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stdint.h>
+#include <type_traits>
+#include <Arduino.h>
+#include "Communication.h"
+
+/**
+ * @brief Ajastimen tilastot viimeisimmästä nollauksesta lähtien.
+ */
+struct SchedulerStats {
+    uint32_t overruns;       ///< Väliin jääneiden jaksojen määrä.
+    uint32_t maxLatenessUs;  ///< Suurin myöhästyminen määräajasta (jitter).
+    uint32_t meanLatenessUs; ///< Keskimääräinen myöhästyminen määräajasta.
+    uint32_t executions;     ///< Suoritettujen lukujen ja lähetysten määrä.
+};
+
+/**
+ * @brief Määräaikojen seuranta ja tilastointi. Scheduler-mallin tyypistä riippumaton osa.
+ */
+class DeadlineTracker {
+public:
+    DeadlineTracker();
+
+    /**
+     * @brief Tarkistaa, onko määräaika erääntynyt, ja siirtää sen seuraavaan jaksoon.
+     *
+     * Määräaika lasketaan edellisestä määräajasta eikä toteutushetkestä, jolloin
+     * myöhästymiset eivät kasaannu. Jos kokonainen jakso jää väliin, kirjataan
+     * ylitys (overrun) ja aikataulu siirretään nykyhetkeen.
+     */
+    bool due(uint32_t& deadline, uint32_t period, uint32_t nowUs);
+
+    /**
+     * @brief Palauttaa tilastot ja nollaa ne.
+     */
+    SchedulerStats takeStats();
+
+private:
+    uint32_t overruns;
+    uint32_t maxLatenessUs;
+    uint64_t totalLatenessUs;
+    uint32_t executions;
+};
+
+/**
+ * @brief Määräaikoihin perustuva ajastin antureiden lukemiselle ja lähettämiselle.
+ *
+ * Jokaisella anturilla on oma luku- ja lähetysvälinsä (SAMPLE_PERIOD_US,
+ * SEND_PERIOD_US). run() kutsutaan loop()-funktiosta mahdollisimman usein;
+ * se lukee erääntyneet anturit ja lähettää samalla kierroksella
+ * lähetysvuorossa olevat anturit yhtenä eräkehyksenä. Antureiden läpikäynti
+ * avautuu käännösaikana, joten jokainen kutsu on suora.
+ *
+ * @tparam Registry SensorRegistry-tyyppi.
+ */
+template <typename Registry>
+class Scheduler {
+public:
+    explicit Scheduler(Registry& sensors) : sensors(sensors), sequence(0) {}
+
+    /**
+     * @brief Asettaa ensimmäiset määräajat. Kutsutaan kerran setup()-funktiossa.
+     */
+    void begin(uint32_t nowUs) {
+        for (uint8_t i = 0; i < Registry::COUNT; ++i) {
+            nextSampleUs[i] = nowUs;
+            nextSendUs[i] = nowUs;
+        }
+    }
+
+    /**
+     * @brief Suorittaa erääntyneet luvut ja lähetykset.
+     * @param nowUs Nykyinen aika (micros()).
+     */
+    void run(uint32_t nowUs) {
+        BatchWriter batch(sequence, millis());
+        sensors.forEach([&](auto& sensor, uint8_t i) {
+            using SensorClass = typename std::remove_reference<decltype(sensor)>::type;
+            if (tracker.due(nextSampleUs[i], SensorClass::SAMPLE_PERIOD_US, nowUs)) {
+                sensor.read();
+            }
+            if (tracker.due(nextSendUs[i], SensorClass::SEND_PERIOD_US, nowUs)) {
+                batch.add(SensorClass::TYPE, sensor.getData(), SensorClass::getDataSize(), SensorClass::PRIORITY);
+            }
+        });
+        if (batch.finish()) {
+            ++sequence;
+        }
+    }
+
+    /**
+     * @brief Palauttaa tilastot ja nollaa ne.
+     */
+    SchedulerStats takeStats() { return tracker.takeStats(); }
+
+private:
+    Registry& sensors;
+    DeadlineTracker tracker;
+    uint32_t nextSampleUs[Registry::COUNT];
+    uint32_t nextSendUs[Registry::COUNT];
+    uint16_t sequence;
+};
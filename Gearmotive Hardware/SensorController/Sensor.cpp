@@ -1,4 +1,5 @@
 #include "Sensor.h"
+#include <Arduino.h>
 #include <stdint.h>
 /*Sensor definet tähän
 Kuten
@@ -11,6 +12,13 @@ Kuten
 */
 #include <cstdlib>
 
+// Akselien Hall-anturien pulssitulot ja hammasrattaiden hampaiden määrät.
+// Anturin analoginen lähtö tuodaan nastaan komparaattorin/Schmitt-triggerin kautta.
+#define PRIMARY_AXLE_RPM_PIN 2
+#define PRIMARY_AXLE_TEETH 60
+#define SECONDARY_AXLE_RPM_PIN 3
+#define SECONDARY_AXLE_TEETH 60
+
 // ------ OilTempSensor toteutus ------
 
 void OilTempSensor::begin() {
@@ -28,62 +36,50 @@ void OilTempSensor::read() {
     // temperature = sensorValue * 3.3 / 4095 ;
 }
 
-uint8_t* OilTempSensor::getData() {
-    return reinterpret_cast<uint8_t*>(&temperature);
-}
-
-uint8_t OilTempSensor::getDataSize() {
-    return sizeof(temperature);
-}
-
-SensorType OilTempSensor::getType() {
-    return OIL_TEMPERATURE;
-}
-
 // ------ PrimaryAxleRPMSensor toteutus ------
 
-void PrimaryAxleRPMSensor::begin() {
-    rpm = 800;
-}
+PrimaryAxleRPMSensor* PrimaryAxleRPMSensor::instance = nullptr;
 
-void PrimaryAxleRPMSensor::read() {
-    // Simuloidaan kierrosluvun muutosta
-    rpm = (rpm + 50) % 5000;
+PrimaryAxleRPMSensor::PrimaryAxleRPMSensor()
+    : rpm(0),
+      capture(PRIMARY_AXLE_RPM_PIN, PRIMARY_AXLE_TEETH) {
 }
 
-uint8_t* PrimaryAxleRPMSensor::getData() {
-    return reinterpret_cast<uint8_t*>(&rpm);
+void PrimaryAxleRPMSensor::onEdge() {
+    instance->capture.onEdge();
 }
 
-uint8_t PrimaryAxleRPMSensor::getDataSize() {
-    return sizeof(rpm);
+void PrimaryAxleRPMSensor::begin() {
+    rpm = 0;
+    instance = this;
+    capture.begin(&PrimaryAxleRPMSensor::onEdge);
 }
 
-SensorType PrimaryAxleRPMSensor::getType() {
-    return PRIMARY_AXLE_RPM;
+void PrimaryAxleRPMSensor::read() {
+    rpm = capture.read();
 }
 
 // ------ SecondaryAxleRPMSensor toteutus ------
 
-void SecondaryAxleRPMSensor::begin() {
-    rpm = 300;
-}
+SecondaryAxleRPMSensor* SecondaryAxleRPMSensor::instance = nullptr;
 
-void SecondaryAxleRPMSensor::read() {
-    // Simuloidaan kierrosluvun muutosta
-    rpm = (rpm + 25) % 3000;
+SecondaryAxleRPMSensor::SecondaryAxleRPMSensor()
+    : rpm(0),
+      capture(SECONDARY_AXLE_RPM_PIN, SECONDARY_AXLE_TEETH) {
 }
 
-uint8_t* SecondaryAxleRPMSensor::getData() {
-    return reinterpret_cast<uint8_t*>(&rpm);
+void SecondaryAxleRPMSensor::onEdge() {
+    instance->capture.onEdge();
 }
 
-uint8_t SecondaryAxleRPMSensor::getDataSize() {
-    return sizeof(rpm);
+void SecondaryAxleRPMSensor::begin() {
+    rpm = 0;
+    instance = this;
+    capture.begin(&SecondaryAxleRPMSensor::onEdge);
 }
 
-SensorType SecondaryAxleRPMSensor::getType() {
-    return SECONDARY_AXLE_RPM;
+void SecondaryAxleRPMSensor::read() {
+    rpm = capture.read();
 }
 
 // ------ GearboxTorqueSensor toteutus ------
@@ -100,18 +96,6 @@ void GearboxTorqueSensor::read() {
     }
 }
 
-uint8_t* GearboxTorqueSensor::getData() {
-    return reinterpret_cast<uint8_t*>(&torque);
-}
-
-uint8_t GearboxTorqueSensor::getDataSize() {
-    return sizeof(torque);
-}
-
-SensorType GearboxTorqueSensor::getType() {
-    return GEARBOX_TORQUE;
-}
-
 // ------ BrakeTorqueSensor toteutus ------
 
 void BrakeTorqueSensor::begin() {
@@ -127,18 +111,6 @@ void BrakeTorqueSensor::read() {
     }
 }
 
-uint8_t* BrakeTorqueSensor::getData() {
-    return reinterpret_cast<uint8_t*>(&torque);
-}
-
-uint8_t BrakeTorqueSensor::getDataSize() {
-    return sizeof(torque);
-}
-
-SensorType BrakeTorqueSensor::getType() {
-    return BRAKE_TORQUE;
-}
-
 // ------ AirTempSensor toteutus ------
 
 void AirTempSensor::begin() {
@@ -152,15 +124,3 @@ void AirTempSensor::read() {
         temperature = 15.0;
     }
 }
-
-uint8_t* AirTempSensor::getData() {
-    return reinterpret_cast<uint8_t*>(&temperature);
-}
-
-uint8_t AirTempSensor::getDataSize() {
-    return sizeof(temperature);
-}
-
-SensorType AirTempSensor::getType() {
-    return AIR_TEMPERATURE;
-} 
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdint.h>
+#include "RpmCapture.h"
 
 // Enumeraatio eri anturityypeille.
 // Tämä auttaa QT-sovellusta tunnistamaan, mistä datalähteestä on kyse.
@@ -11,50 +12,32 @@ enum SensorType : uint8_t {
     GEARBOX_TORQUE       = 0x30,
     BRAKE_TORQUE         = 0x31,
     AIR_TEMPERATURE      = 0x40,
+    ACCELERATION_X       = 0x50,
+    ACCELERATION_Y       = 0x51,
+    ACCELERATION_Z       = 0x52,
+    SOUND_LEVEL          = 0x60,
 };
 
-/**
- * @brief Abstrakti kantaluokka kaikille järjestelmän antureille.
- * 
- * Tämä luokka määrittelee yhteisen rajapinnan, jota kaikkien
- * anturiluokkien on noudatettava. Tämä tekee antureiden käsittelystä
- * yhtenäistä ja uusien antureiden lisäämisestä helppoa
+/*
+ * Anturiluokkien yhteinen rajapinta.
+ *
+ * Anturit kootaan käännösaikaiseen rekisteriin (SensorRegistry.h), joka
+ * kutsuu niitä suoraan ilman virtuaalifunktioita. Jokaisen anturiluokan
+ * on tarjottava seuraavat jäsenet:
+ *
+ * - static constexpr SensorType TYPE          Anturin tyyppi.
+ * - static constexpr uint32_t SAMPLE_PERIOD_US Lukuväli mikrosekunteina.
+ * - static constexpr uint32_t SEND_PERIOD_US   Lähetysväli mikrosekunteina.
+ * - static constexpr uint8_t PRIORITY          Lähetysprioriteetti linjan
+ *                                              ruuhkautuessa, suurempi on tärkeämpi.
+ * - void begin()                               Alustaa anturin. Kutsutaan kerran setup()-funktiossa.
+ * - void read()                                Lukee uuden arvon anturilta.
+ * - const uint8_t* getData() const             Osoitin anturin dataan.
+ * - static constexpr uint8_t getDataSize()     Datan koko tavuina.
+ *
+ * Uusi anturi lisätään kirjoittamalla luokka tähän ja lisäämällä se
+ * SensorController.ino:n rekisteriin; antureiden määrä lasketaan automaattisesti.
  */
-class Sensor {
-public:
-    /**
-     * @brief Alustaa anturin. Kutsutaan kerran setup()-funktiossa.
-     */
-    virtual void begin() = 0;
-
-    /**
-     * @brief Lukee uuden arvon anturilta. Kutsutaan säännöllisesti loop()-funktiossa. ts. tähän logiikka joka lukee anturin arvon
-     */
-    virtual void read() = 0;
-
-    /**
-     * @brief Palauttaa osoittimen anturin dataan.
-     * @return uint8_t* Osoitin databufferiin.
-     */
-    virtual uint8_t* getData() = 0;
-
-    /**
-     * @brief Palauttaa anturin datan koon tavuina.
-     * @return uint8_t Datan koko.
-     */
-    virtual uint8_t getDataSize() = 0;
-
-    /**
-     * @brief Palauttaa anturin tyypin SensorType-enumeraationa.
-     * @return SensorType Anturin tyyppi.
-     */
-    virtual SensorType getType() = 0;
-    
-    /**
-     * @brief Virtuaalinen purkaja on tärkeä kantaluokille.
-     */
-    virtual ~Sensor() {} 
-}; 
 
 
 // ------ Antureiden luokkamäärittelyt ------
@@ -62,83 +45,115 @@ public:
 /**
  * @brief Öljyn lämpötila-anturi.
  */
-class OilTempSensor : public Sensor {
+class OilTempSensor {
 private:
     float temperature;
 public:
-    void begin() override;
-    void read() override;
-    uint8_t* getData() override;
-    uint8_t getDataSize() override;
-    SensorType getType() override;
+    static constexpr SensorType TYPE = OIL_TEMPERATURE;
+    static constexpr uint32_t SAMPLE_PERIOD_US = 1000000UL; // Luetaan ja lähetetään 1 Hz
+    static constexpr uint32_t SEND_PERIOD_US = 1000000UL;
+    static constexpr uint8_t PRIORITY = 2;
+
+    void begin();
+    void read();
+    const uint8_t* getData() const { return reinterpret_cast<const uint8_t*>(&temperature); }
+    static constexpr uint8_t getDataSize() { return sizeof(float); }
 };
 
 /**
  * @brief Ensiöakselin kierrosnopeusanturi.
  */
-class PrimaryAxleRPMSensor : public Sensor {
+class PrimaryAxleRPMSensor {
 private:
     uint16_t rpm;
+    RpmCapture capture;
+    static PrimaryAxleRPMSensor* instance; // Keskeytyspalvelua varten
+    static void onEdge();
 public:
-    void begin() override;
-    void read() override;
-    uint8_t* getData() override;
-    uint8_t getDataSize() override;
-    SensorType getType() override;
+    static constexpr SensorType TYPE = PRIMARY_AXLE_RPM;
+    static constexpr uint32_t SAMPLE_PERIOD_US = 1000UL; // Luetaan 1 kHz, lähetetään 100 Hz
+    static constexpr uint32_t SEND_PERIOD_US = 10000UL;
+    static constexpr uint8_t PRIORITY = 0;
+
+    PrimaryAxleRPMSensor();
+    void begin();
+    void read();
+    const uint8_t* getData() const { return reinterpret_cast<const uint8_t*>(&rpm); }
+    static constexpr uint8_t getDataSize() { return sizeof(uint16_t); }
 };
 
 /**
  * @brief Toisioakselin kierrosnopeusanturi.
  */
-class SecondaryAxleRPMSensor : public Sensor {
+class SecondaryAxleRPMSensor {
 private:
     uint16_t rpm;
+    RpmCapture capture;
+    static SecondaryAxleRPMSensor* instance; // Keskeytyspalvelua varten
+    static void onEdge();
 public:
-    void begin() override;
-    void read() override;
-    uint8_t* getData() override;
-    uint8_t getDataSize() override;
-    SensorType getType() override;
+    static constexpr SensorType TYPE = SECONDARY_AXLE_RPM;
+    static constexpr uint32_t SAMPLE_PERIOD_US = 1000UL; // Luetaan 1 kHz, lähetetään 100 Hz
+    static constexpr uint32_t SEND_PERIOD_US = 10000UL;
+    static constexpr uint8_t PRIORITY = 0;
+
+    SecondaryAxleRPMSensor();
+    void begin();
+    void read();
+    const uint8_t* getData() const { return reinterpret_cast<const uint8_t*>(&rpm); }
+    static constexpr uint8_t getDataSize() { return sizeof(uint16_t); }
 };
 
 /**
  * @brief Vaihteiston vääntömomenttianturi.
  */
-class GearboxTorqueSensor : public Sensor {
+class GearboxTorqueSensor {
 private:
     float torque;
 public:
-    void begin() override;
-    void read() override;
-    uint8_t* getData() override;
-    uint8_t getDataSize() override;
-    SensorType getType() override;
+    static constexpr SensorType TYPE = GEARBOX_TORQUE;
+    static constexpr uint32_t SAMPLE_PERIOD_US = 2000UL; // Luetaan 500 Hz, lähetetään 50 Hz
+    static constexpr uint32_t SEND_PERIOD_US = 20000UL;
+    static constexpr uint8_t PRIORITY = 1;
+
+    void begin();
+    void read();
+    const uint8_t* getData() const { return reinterpret_cast<const uint8_t*>(&torque); }
+    static constexpr uint8_t getDataSize() { return sizeof(float); }
 };
 
 /**
  * @brief Jarrun vääntömomenttianturi.
  */
-class BrakeTorqueSensor : public Sensor {
+class BrakeTorqueSensor {
 private:
     float torque;
 public:
-    void begin() override;
-    void read() override;
-    uint8_t* getData() override;
-    uint8_t getDataSize() override;
-    SensorType getType() override;
+    static constexpr SensorType TYPE = BRAKE_TORQUE;
+    static constexpr uint32_t SAMPLE_PERIOD_US = 2000UL; // Luetaan 500 Hz, lähetetään 50 Hz
+    static constexpr uint32_t SEND_PERIOD_US = 20000UL;
+    static constexpr uint8_t PRIORITY = 1;
+
+    void begin();
+    void read();
+    const uint8_t* getData() const { return reinterpret_cast<const uint8_t*>(&torque); }
+    static constexpr uint8_t getDataSize() { return sizeof(float); }
 };
 
 /**
  * @brief Ilman lämpötila-anturi.
  */
-class AirTempSensor : public Sensor {
+class AirTempSensor {
 private:
     float temperature;
 public:
-    void begin() override;
-    void read() override;
-    uint8_t* getData() override;
-    uint8_t getDataSize() override;
-    SensorType getType() override;
-}; 
\ No newline at end of file
+    static constexpr SensorType TYPE = AIR_TEMPERATURE;
+    static constexpr uint32_t SAMPLE_PERIOD_US = 1000000UL; // Luetaan ja lähetetään 1 Hz
+    static constexpr uint32_t SEND_PERIOD_US = 1000000UL;
+    static constexpr uint8_t PRIORITY = 2;
+
+    void begin();
+    void read();
+    const uint8_t* getData() const { return reinterpret_cast<const uint8_t*>(&temperature); }
+    static constexpr uint8_t getDataSize() { return sizeof(float); }
+};
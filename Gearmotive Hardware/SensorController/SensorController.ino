@@ -1,39 +1,56 @@
 #include <Arduino.h>
 #include "Sensor.h"
 #include "Communication.h"
+#include "Scheduler.h"
+#include "SensorRegistry.h"
 
 // Asetukset
 #define BAUD_RATE 115200 // QT:n päässä oltava myös 115200
-#define SENSOR_COUNT 6 // Tämä pitää muistaa päivittää aina kun lisätään sensoreita
-#define SEND_INTERVAL 1000 
 #define ADC_RESOLUTION 12 // 12 bit ADC
+#define STATUS_INTERVAL_US 1000000UL // Tilakehys kerran sekunnissa
+#define TX_OVERFLOW_POLICY DROP_LOWEST_PRIORITY
 
-Sensor* sensors[SENSOR_COUNT];
+// Anturirekisteri. Uusi anturi lisätään tähän listaan; määrä lasketaan automaattisesti
+// ja anturit varataan staattisesti ilman kekomuistia.
+using Sensors = SensorRegistry<
+    OilTempSensor,
+    PrimaryAxleRPMSensor,
+    SecondaryAxleRPMSensor,
+    GearboxTorqueSensor,
+    BrakeTorqueSensor,
+    AirTempSensor
+>;
+
+Sensors sensors;
+Scheduler<Sensors> scheduler(sensors);
+uint32_t nextStatusUs;
 
 void setup() {
     Serial.begin(BAUD_RATE);
+    beginCommunication(TX_OVERFLOW_POLICY);
     analogReadResolution(ADC_RESOLUTION);
 
     //while (!Serial); // Odota, että sarjaportti on valmis
 
-    // Alustetaan sensorit ja lisätään ne rekisteriin
-    sensors[0] = new OilTempSensor();
-    sensors[1] = new PrimaryAxleRPMSensor();
-    sensors[2] = new SecondaryAxleRPMSensor();
-    sensors[3] = new GearboxTorqueSensor();
-    sensors[4] = new BrakeTorqueSensor();
-    sensors[5] = new AirTempSensor();
-
-    for (int i = 0; i < SENSOR_COUNT; ++i) {
-        sensors[i]->begin();
-    }
+    // Alustetaan sensorit
+    sensors.forEach([](auto& sensor, uint8_t) {
+        sensor.begin();
+    });
+    scheduler.begin(micros());
+    nextStatusUs = micros() + STATUS_INTERVAL_US;
 }
 
 void loop() {
-    // Käydään kaikki sensorit läpi, luetaan data ja lähetetään se
-    for (int i = 0; i < SENSOR_COUNT; ++i) {
-        sensors[i]->read();
-        sendSensorData(sensors[i]);
+    // Jokainen anturi luetaan ja lähetetään omalla tahdillaan. Kaikki samalla
+    // kierroksella lähetysvuorossa olevat anturit lähtevät yhtenä kehyksenä.
+    uint32_t now = micros();
+    scheduler.run(now);
+
+    if ((int32_t)(now - nextStatusUs) >= 0) {
+        nextStatusUs += STATUS_INTERVAL_US;
+        sendStatus(scheduler.takeStats());
     }
-    delay(SEND_INTERVAL); 
+
+    // Lähetys ei koskaan odota UARTia; jono tyhjenee sitä mukaa kuin tilaa vapautuu
+    pumpCommunication();
 }
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <tuple>
+#include <utility>
+
+/**
+ * @brief Käännösaikainen anturirekisteri.
+ *
+ * Anturit säilötään staattisesti yhteen olioon ilman kekomuistia, ja niiden
+ * määrä saadaan suoraan tyyppilistasta. forEach() avautuu käännösaikana
+ * jokaisen anturin suoraksi kutsuksi, joten virtuaalifunktioita ei tarvita.
+ *
+ * Esimerkki:
+ * @code
+ * SensorRegistry<OilTempSensor, AirTempSensor> sensors;
+ * sensors.forEach([](auto& sensor, uint8_t index) { sensor.read(); });
+ * @endcode
+ *
+ * @tparam Sensors Anturiluokat, ks. rajapinnan kuvaus Sensor.h:ssa.
+ */
+template <typename... Sensors>
+class SensorRegistry {
+public:
+    static constexpr uint8_t COUNT = sizeof...(Sensors);
+
+    static_assert(sizeof...(Sensors) > 0 && sizeof...(Sensors) < 256, "Registry must hold 1-255 sensors");
+
+    /**
+     * @brief Kutsuu funktiota jokaiselle anturille rekisteröintijärjestyksessä.
+     * @param f Funktio muotoa f(anturi&, indeksi).
+     */
+    template <typename F>
+    void forEach(F&& f) {
+        forEachImpl(f, std::make_index_sequence<sizeof...(Sensors)>());
+    }
+
+private:
+    static constexpr bool typesAreUnique() {
+        const uint8_t types[] = { (uint8_t)Sensors::TYPE... };
+        for (size_t i = 0; i < sizeof...(Sensors); ++i) {
+            for (size_t j = i + 1; j < sizeof...(Sensors); ++j) {
+                if (types[i] == types[j]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    static_assert(typesAreUnique(), "Each sensor type may be registered only once");
+
+    template <typename F, size_t... I>
+    void forEachImpl(F& f, std::index_sequence<I...>) {
+        (f(std::get<I>(sensors), std::integral_constant<uint8_t, (uint8_t)I>()), ...);
+    }
+
+    std::tuple<Sensors...> sensors;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @brief Lukitukseton rengaspuskuri yhdelle tuottajalle ja yhdelle kuluttajalle.
+ *
+ * Tarkoitettu datan välittämiseen keskeytyspalvelusta (tuottaja) loop()-
+ * funktioon (kuluttaja) ilman keskeytysten estämistä. Kumpikin osapuoli
+ * kirjoittaa vain omaa indeksiään, joten atominen luku/kirjoitus riittää.
+ *
+ * @tparam T Alkion tyyppi.
+ * @tparam N Puskurin koko, oltava kahden potenssi ja enintään 256. Puskuriin
+ *           mahtuu kerralla N - 1 alkiota.
+ */
+template <typename T, uint16_t N>
+class SpscRing {
+    static_assert(N > 0 && N <= 256 && (N & (N - 1)) == 0, "N must be a power of two <= 256");
+
+public:
+    SpscRing() : head(0), tail(0) {}
+
+    /**
+     * @brief Lisää alkion. Kutsutaan vain tuottajalta (ISR).
+     * @return false, jos puskuri on täynnä ja alkio hylättiin.
+     */
+    bool push(const T& value) {
+        uint8_t h = head.load(std::memory_order_relaxed);
+        uint8_t next = (uint8_t)((h + 1) & (N - 1));
+        if (next == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        buffer[h] = value;
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Poistaa vanhimman alkion. Kutsutaan vain kuluttajalta (loop()).
+     * @return false, jos puskuri on tyhjä.
+     */
+    bool pop(T& value) {
+        uint8_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = buffer[t];
+        uint8_t next = (uint8_t)((t + 1) & (N - 1));
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T buffer[N];
+    std::atomic<uint8_t> head;
+    std::atomic<uint8_t> tail;
+};
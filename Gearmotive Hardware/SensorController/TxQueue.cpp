@@ -0,0 +1,110 @@
+#include "TxQueue.h"
+#include <Arduino.h>
+#include <string.h>
+
+TxQueue::TxQueue(TxOverflowPolicy policy)
+    : policy(policy), encoder(encodeFrameV1), count(0), wireSize(0), sentBytes(0), droppedFrames(0) {
+    for (uint8_t i = 0; i < TX_SLOT_COUNT; ++i) {
+        order[i] = i;
+    }
+}
+
+int8_t TxQueue::findVictim(uint8_t newPriority) const {
+    // Lähetyksessä oleva kehys on jo siirretty pois jonosta, joten mikä
+    // tahansa jonon kehys voidaan pudottaa katkaisematta virtaa
+    if (count == 0) {
+        return -1;
+    }
+
+    if (policy == DROP_LOWEST_PRIORITY) {
+        // Matalin prioriteetti, tasatilanteessa vanhin (ensimmäinen järjestyksessä)
+        int8_t victim = 0;
+        for (uint8_t i = 1; i < count; ++i) {
+            if (slots[order[i]].priority < slots[order[victim]].priority) {
+                victim = i;
+            }
+        }
+        // -1 tarkoittaa, että uusi kehys on itse vähiten tärkeä; saman
+        // prioriteetin vanha kehys väistyy uudemman tieltä
+        return slots[order[victim]].priority <= newPriority ? victim : -1;
+    }
+    return 0;
+}
+
+void TxQueue::removeAt(uint8_t position) {
+    uint8_t slot = order[position];
+    for (uint8_t i = position; i + 1 < count; ++i) {
+        order[i] = order[i + 1];
+    }
+    --count;
+    order[count] = slot;
+}
+
+bool TxQueue::enqueue(const uint8_t* frame, uint8_t size, uint8_t priority, uint32_t key) {
+    if (size > TX_SLOT_SIZE) {
+        ++droppedFrames;
+        return false;
+    }
+
+    if (count == TX_SLOT_COUNT) {
+        if (policy == COALESCE) {
+            // Uudempi kehys samoista antureista korvaa vanhan paikallaan
+            for (uint8_t i = 0; i < count; ++i) {
+                Slot& slot = slots[order[i]];
+                if (slot.key == key) {
+                    memcpy(slot.data, frame, size);
+                    slot.size = size;
+                    slot.priority = priority;
+                    ++droppedFrames;
+                    return true;
+                }
+            }
+        }
+
+        int8_t victim = findVictim(priority);
+        ++droppedFrames;
+        if (victim < 0) {
+            return false;
+        }
+        removeAt((uint8_t)victim);
+    }
+
+    Slot& slot = slots[order[count++]];
+    memcpy(slot.data, frame, size);
+    slot.size = size;
+    slot.priority = priority;
+    slot.key = key;
+    return true;
+}
+
+void TxQueue::pump() {
+    for (;;) {
+        int space = Serial.availableForWrite();
+        if (space <= 0) {
+            return;
+        }
+
+        if (sentBytes == wireSize) {
+            if (count == 0) {
+                return;
+            }
+            // Kehys koodataan vasta kun UART ottaa sen vastaan; siihen asti se
+            // on jonossa pudotettavissa ja korvattavissa
+            const Slot& slot = slots[order[0]];
+            wireSize = encoder(slot.data, slot.size, wire);
+            sentBytes = 0;
+            removeAt(0);
+        }
+
+        uint8_t remaining = wireSize - sentBytes;
+        uint8_t chunk = (uint8_t)(space < remaining ? space : remaining);
+        Serial.write(wire + sentBytes, chunk);
+        sentBytes += chunk;
+    }
+}
+
+uint32_t TxQueue::takeDroppedFrames() {
+    uint32_t dropped = droppedFrames;
+    droppedFrames = 0;
+    return dropped;
+}
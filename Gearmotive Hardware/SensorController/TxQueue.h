@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdint.h>
+#include "Framing.h"
+
+#define TX_SLOT_COUNT 16 // Jonossa kerralla olevien kehysten enimmäismäärä
+#define TX_SLOT_SIZE 64  // Yhden koodaamattoman kehyksen (tyyppi, pituus, data) enimmäiskoko tavuina
+
+/**
+ * @brief Koodaa kehyksen lähetysmuotoon, ks. encodeFrameV1().
+ */
+typedef uint8_t (*TxEncoder)(const uint8_t* raw, uint8_t rawSize, uint8_t* wire);
+
+/**
+ * @brief Mitä tehdään, kun lähetysjono on täynnä.
+ */
+enum TxOverflowPolicy : uint8_t {
+    DROP_OLDEST,          ///< Pudotetaan vanhin jonossa odottava kehys.
+    DROP_LOWEST_PRIORITY, ///< Pudotetaan matalimman prioriteetin kehys (tasatilanteessa vanhin).
+    COALESCE,             ///< Korvataan jonossa odottava kehys, jolla on sama avain. Muuten kuten DROP_OLDEST.
+};
+
+/**
+ * @brief Estämätön lähetysjono sarjaportille.
+ *
+ * enqueue() ei koskaan odota UARTia, joten mittaus ja aikaleimat eivät
+ * viivästy, vaikka linja ruuhkautuisi. pump() kirjoittaa jonoa UARTiin vain
+ * niin paljon kuin sen lähetyspuskuriin mahtuu. Jos jono täyttyy, kehyksiä
+ * pudotetaan valitun käytännön mukaan ja pudotukset lasketaan.
+ *
+ * Jonossa kehykset ovat koodaamattomina, ja ne koodataan vasta lähetyksen
+ * alkaessa. Näin protokollaversion vaihto osuu aina kehysten väliin.
+ */
+class TxQueue {
+public:
+    explicit TxQueue(TxOverflowPolicy policy);
+
+    void setPolicy(TxOverflowPolicy newPolicy) { policy = newPolicy; }
+
+    /**
+     * @brief Vaihtaa koodauksen. Koskee kehyksiä, joiden lähetys ei ole vielä alkanut.
+     */
+    void setEncoder(TxEncoder newEncoder) { encoder = newEncoder; }
+
+    /**
+     * @brief Lisää valmiin kehyksen jonoon.
+     * @param frame Koodaamaton kehys: tyyppi, datan pituus ja data.
+     * @param size Kehyksen koko, enintään TX_SLOT_SIZE.
+     * @param priority Kehyksen prioriteetti, suurempi on tärkeämpi.
+     * @param key Tunniste COALESCE-käytäntöä varten (esim. kehyksen antureiden bittimaski).
+     * @return false, jos juuri tämä kehys pudotettiin.
+     */
+    bool enqueue(const uint8_t* frame, uint8_t size, uint8_t priority, uint32_t key);
+
+    /**
+     * @brief Siirtää jonosta dataa UARTin lähetyspuskuriin odottamatta.
+     */
+    void pump();
+
+    /**
+     * @brief Palauttaa pudotettujen kehysten määrän ja nollaa laskurin.
+     */
+    uint32_t takeDroppedFrames();
+
+private:
+    struct Slot {
+        uint8_t data[TX_SLOT_SIZE];
+        uint8_t size;
+        uint8_t priority;
+        uint32_t key;
+    };
+
+    int8_t findVictim(uint8_t newPriority) const;
+    void removeAt(uint8_t position);
+
+    TxOverflowPolicy policy;
+    TxEncoder encoder;
+    Slot slots[TX_SLOT_COUNT];
+    uint8_t order[TX_SLOT_COUNT]; // Jonon järjestys slot-indekseinä, vanhin ensin
+    uint8_t count;
+    uint8_t wire[WIRE_FRAME_SIZE(TX_SLOT_SIZE)]; // Lähetyksessä oleva koodattu kehys
+    uint8_t wireSize;
+    uint8_t sentBytes;            // Kuinka paljon koodatusta kehyksestä on jo lähetetty
+    uint32_t droppedFrames;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+/**
+ * @file Arduino.h
+ * @brief Arduino-rajapinnan korvike SensorController-ohjelmiston ajamiseen PC:llä.
+ *
+ * Toteuttaa vain ne osat, joita ohjelmisto käyttää. Serial kirjoittaa
+ * pseudopäätteeseen (tai putkeen), johon Qt-sovelluksen DataReceiver voi
+ * yhdistää kuin oikeaan sarjaporttiin. Lähetysnopeutta rajoitetaan
+ * asetetun baudinopeuden mukaan, jotta ruuhkautuminen käyttäytyy kuten
+ * laitteella.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+class HostSerial {
+public:
+    void begin(unsigned long baud);
+    void end();
+
+    size_t write(uint8_t byte);
+    size_t write(const uint8_t* buffer, size_t size);
+
+    /**
+     * @brief Kuinka monta tavua voidaan kirjoittaa heti. Mallintaa UARTin 64 tavun lähetyspuskuria.
+     */
+    int availableForWrite();
+
+    int available();
+    int read();
+
+    operator bool() const { return fd >= 0; }
+
+    /**
+     * @brief Käyttää annettua tiedostokuvaajaa pseudopäätteen sijaan (esim. stdout-putki).
+     */
+    void useFileDescriptor(int descriptor);
+
+    /**
+     * @brief Luo symbolisen linkin pseudopäätteen orjapuoleen vakiopolkuun.
+     */
+    void setLinkPath(const char* path);
+
+    /**
+     * @brief Palauttaa pseudopäätteen orjapuolen polun, johon vastaanottaja yhdistää.
+     */
+    const char* portName() const { return slaveName; }
+
+private:
+    void refill();
+
+    int fd = -1;
+    bool ownsFd = false;
+    unsigned long baudRate = 115200;
+    double txCredit = 0.0;      // Lähetyspuskurissa vapaana olevat tavut
+    uint32_t lastRefillUs = 0;
+    int peeked = -1;
+    char slaveName[256] = {0};
+    char linkPath[256] = {0};
+};
+
+extern HostSerial Serial;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int analogRead(uint8_t pin);
+void analogReadResolution(int bits);
+
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(int interrupt, void (*isr)(), int mode);
+void detachInterrupt(int interrupt);
+
+/**
+ * @brief Simuloi pulssit kaikille kytketyille keskeytyksille.
+ *
+ * Kutsutaan host-pääsilmukasta. Pulssitaajuus asetetaan hostSetEdgeRate():lla.
+ */
+void hostPollInterrupts();
+
+/**
+ * @brief Asettaa simuloitujen pulssien taajuuden (Hz) annetulle nastalle.
+ */
+void hostSetEdgeRate(uint8_t pin, double hz);
@@ -0,0 +1,224 @@
+#include "Arduino.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+HostSerial Serial;
+
+namespace {
+
+const int MAX_PINS = 64;
+const double UART_TX_BUFFER = 64.0;
+
+const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+struct InterruptPin {
+    void (*isr)() = nullptr;
+    double edgeRateHz = 0.0;
+    double nextEdgeUs = 0.0;
+};
+
+InterruptPin pins[MAX_PINS];
+int adcBits = 10;
+
+} // namespace
+
+// ------ Aika ------
+
+uint32_t micros() {
+    auto elapsed = std::chrono::steady_clock::now() - startTime;
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+uint32_t millis() {
+    auto elapsed = std::chrono::steady_clock::now() - startTime;
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+}
+
+void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+// ------ GPIO ja ADC ------
+
+void pinMode(uint8_t, uint8_t) {
+}
+
+int analogRead(uint8_t pin) {
+    // Hitaasti vaihteleva signaali, jotta kuvaajassa näkyy jotain
+    double phase = micros() / 1e6 + pin;
+    double normalized = 0.5 + 0.4 * std::sin(phase);
+    return (int)(normalized * ((1 << adcBits) - 1));
+}
+
+void analogReadResolution(int bits) {
+    adcBits = bits;
+}
+
+int digitalPinToInterrupt(uint8_t pin) {
+    return pin < MAX_PINS ? pin : -1;
+}
+
+void attachInterrupt(int interrupt, void (*isr)(), int) {
+    if (interrupt >= 0 && interrupt < MAX_PINS) {
+        pins[interrupt].isr = isr;
+        pins[interrupt].nextEdgeUs = micros();
+    }
+}
+
+void detachInterrupt(int interrupt) {
+    if (interrupt >= 0 && interrupt < MAX_PINS) {
+        pins[interrupt].isr = nullptr;
+    }
+}
+
+void hostSetEdgeRate(uint8_t pin, double hz) {
+    if (pin < MAX_PINS) {
+        pins[pin].edgeRateHz = hz;
+    }
+}
+
+void hostPollInterrupts() {
+    double now = micros();
+    for (InterruptPin& pin : pins) {
+        if (!pin.isr || pin.edgeRateHz <= 0.0) {
+            continue;
+        }
+        // Laukaistaan kaikki erääntyneet pulssit; oikealla laitteella ne tulisivat keskeytyksinä
+        double period = 1e6 / pin.edgeRateHz;
+        while (pin.nextEdgeUs <= now) {
+            pin.isr();
+            pin.nextEdgeUs += period;
+        }
+    }
+}
+
+// ------ Sarjaportti ------
+
+void HostSerial::begin(unsigned long baud) {
+    baudRate = baud;
+    txCredit = UART_TX_BUFFER;
+    lastRefillUs = micros();
+
+    if (fd >= 0) {
+        return; // useFileDescriptor() on jo asettanut kohteen
+    }
+
+    fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+        perror("posix_openpt");
+        exit(1);
+    }
+    ownsFd = true;
+
+    // Raakatila, jotta tavuja ei tulkita rivinvaihdoiksi tms.
+    termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    snprintf(slaveName, sizeof(slaveName), "%s", ptsname(fd));
+    if (linkPath[0] != '\0') {
+        unlink(linkPath);
+        if (symlink(slaveName, linkPath) == 0) {
+            snprintf(slaveName, sizeof(slaveName), "%s", linkPath);
+        } else {
+            perror("symlink");
+        }
+    }
+    fprintf(stderr, "SensorController host: sarjaportti %s (%lu baud)\n", slaveName, baudRate);
+}
+
+void HostSerial::end() {
+    if (ownsFd && fd >= 0) {
+        close(fd);
+    }
+    if (linkPath[0] != '\0') {
+        unlink(linkPath);
+    }
+    fd = -1;
+}
+
+void HostSerial::useFileDescriptor(int descriptor) {
+    fd = descriptor;
+    ownsFd = false;
+    snprintf(slaveName, sizeof(slaveName), "fd:%d", descriptor);
+}
+
+void HostSerial::setLinkPath(const char* path) {
+    snprintf(linkPath, sizeof(linkPath), "%s", path);
+}
+
+void HostSerial::refill() {
+    uint32_t now = micros();
+    // 10 bittiä tavua kohden (start + 8 data + stop)
+    txCredit += (now - lastRefillUs) * (baudRate / 10.0) / 1e6;
+    if (txCredit > UART_TX_BUFFER) {
+        txCredit = UART_TX_BUFFER;
+    }
+    lastRefillUs = now;
+}
+
+int HostSerial::availableForWrite() {
+    refill();
+    return (int)txCredit;
+}
+
+size_t HostSerial::write(uint8_t byte) {
+    return write(&byte, 1);
+}
+
+size_t HostSerial::write(const uint8_t* buffer, size_t size) {
+    if (fd < 0) {
+        return 0;
+    }
+    refill();
+    txCredit -= size;
+
+    size_t written = 0;
+    while (written < size) {
+        ssize_t n = ::write(fd, buffer + written, size - written);
+        if (n > 0) {
+            written += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            // Kukaan ei lue pseudopäätettä ja sen puskuri on täynnä: data katoaa kuten linjalla
+            break;
+        }
+    }
+    return size;
+}
+
+int HostSerial::available() {
+    if (peeked >= 0) {
+        return 1;
+    }
+    uint8_t byte;
+    if (fd >= 0 && ::read(fd, &byte, 1) == 1) {
+        peeked = byte;
+        return 1;
+    }
+    return 0;
+}
+
+int HostSerial::read() {
+    if (!available()) {
+        return -1;
+    }
+    int byte = peeked;
+    peeked = -1;
+    return byte;
+}
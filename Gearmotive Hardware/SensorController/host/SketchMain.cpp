@@ -0,0 +1,2 @@
+// Sketsi käännetään C++-tiedostona kuten Arduino-ympäristö tekee.
+#include "../SensorController.ino"
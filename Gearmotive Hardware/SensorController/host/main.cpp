@@ -0,0 +1,84 @@
+/**
+ * @file main.cpp
+ * @brief SensorController-ohjelmiston ajo PC:llä ilman laitetta.
+ *
+ * Ajaa sketsin setup()- ja loop()-funktiot stub-Arduino-rajapinnan päällä.
+ * Data kirjoitetaan pseudopäätteeseen, jonka polku tulostetaan
+ * käynnistyessä; Qt-sovelluksessa se valitaan kohdasta "Muu portti...".
+ *
+ * Käyttö:
+ *   sensorcontroller_host [--link POLKU] [--stdout] [--edge-rate PINNI:HZ]...
+ *
+ *   --link POLKU         Luo pseudopäätteelle symbolisen linkin, esim. /tmp/gearmotive
+ *   --stdout             Kirjoita data stdoutiin pseudopäätteen sijaan (putkia varten)
+ *   --edge-rate PINNI:HZ Simuloi kierrosnopeusanturin pulsseja nastaan (oletus 2:1000 ja 3:500)
+ *   --duration S         Lopeta S sekunnin jälkeen (mittauksia varten)
+ */
+
+#include "Arduino.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+
+void setup();
+void loop();
+
+namespace {
+
+volatile std::sig_atomic_t running = 1;
+
+void handleSignal(int) {
+    running = 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    double durationS = 0.0;
+    bool customEdges = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--link") == 0 && i + 1 < argc) {
+            Serial.setLinkPath(argv[++i]);
+        } else if (strcmp(argv[i], "--stdout") == 0) {
+            Serial.useFileDescriptor(STDOUT_FILENO);
+        } else if (strcmp(argv[i], "--edge-rate") == 0 && i + 1 < argc) {
+            unsigned pin = 0;
+            double hz = 0.0;
+            if (sscanf(argv[++i], "%u:%lf", &pin, &hz) == 2) {
+                hostSetEdgeRate((uint8_t)pin, hz);
+                customEdges = true;
+            }
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            durationS = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "Tuntematon argumentti: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (!customEdges) {
+        // 60 hampaalla 1000 Hz vastaa 1000 rpm ja 500 Hz 500 rpm
+        hostSetEdgeRate(2, 1000.0);
+        hostSetEdgeRate(3, 500.0);
+    }
+
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    setup();
+
+    const uint32_t endMs = (uint32_t)(durationS * 1000.0);
+    while (running && (durationS <= 0.0 || millis() < endMs)) {
+        hostPollInterrupts();
+        loop();
+        // Annetaan prosessorille hengähdystauko; ajastin sietää pienen myöhästymisen
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    Serial.end();
+    return 0;
+}